@@ -0,0 +1,412 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+// Offline benchmark of PlutotvData: LoadChannelData, RefreshEpg, GetEPGForChannel and
+// GetChannelStreamProperties as the add-on runs them, linked against the stub Kodi headers in
+// stubs/. The API is served by ReplayTransport, from recorded responses or from ones generated by
+// Fixtures; replayed conditional GETs hash the recording for their ETag, which is part of the
+// measured time. Every operation runs in a process of its own, so its peak RSS is the high-water
+// mark of that process alone, setup included.
+
+#include "Fixtures.h"
+#include "PlutotvHarness.h"
+#include "ReplayTransport.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <new>
+#include <string>
+#include <string_view>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+atomic<size_t> g_allocations{0};
+atomic<size_t> g_allocatedBytes{0};
+
+// the names ReplayTransport looks the API requests up by; the EPG one answers for any window
+const char* const CHANNELS_RECORDING = "GET_api.pluto.tv_v2_channels.json.body";
+const char* const EPG_RECORDING = "GET_api.pluto.tv_v2_channels.body";
+
+struct Options
+{
+  int channels = 300;
+  int iterations = 5;
+  vector<int> hours = {24, 48, 72};
+  string replay;
+};
+
+// an EPG window and the directory serving it
+struct Window
+{
+  string label;
+  string directory;
+  time_t start;
+  time_t end;
+};
+
+struct Result
+{
+  string name;
+  int iterations;
+  double minMs;
+  double medianMs;
+  size_t allocations;
+  size_t allocatedBytes;
+  long peakRssKb;
+};
+
+long PeakRssKb()
+{
+  struct rusage usage
+  {
+  };
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss; // KiB on Linux
+}
+
+void Fail(const string& what)
+{
+  fprintf(stderr, "%s\n", what.c_str());
+  exit(1);
+}
+
+// setup runs before every iteration and is neither timed nor counted
+Result Run(const string& name,
+           int iterations,
+           const function<void()>& setup,
+           const function<void()>& operation)
+{
+  vector<double> times;
+  size_t allocations = 0;
+  size_t allocatedBytes = 0;
+  for (int i = 0; i < iterations; ++i)
+  {
+    if (setup)
+      setup();
+    const size_t allocationsBefore = g_allocations;
+    const size_t bytesBefore = g_allocatedBytes;
+    const auto start = chrono::steady_clock::now();
+    operation();
+    times.push_back(
+        chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    allocations += g_allocations - allocationsBefore;
+    allocatedBytes += g_allocatedBytes - bytesBefore;
+  }
+  sort(times.begin(), times.end());
+
+  return {name,
+          iterations,
+          times.front(),
+          times[times.size() / 2],
+          allocations / iterations,
+          allocatedBytes / iterations,
+          PeakRssKb()};
+}
+
+void Print(const Result& result)
+{
+  printf("%-22s %6i %10.2f %10.2f %12zu %14zu %12li\n", result.name.c_str(), result.iterations,
+         result.minMs, result.medianMs, result.allocations, result.allocatedBytes / 1024,
+         result.peakRssKb);
+}
+
+std::unique_ptr<HttpTransport> Replay(const string& directory)
+{
+  return std::unique_ptr<HttpTransport>(new ReplayTransport(directory, 0, 0));
+}
+
+void Load(PlutotvHarness& harness)
+{
+  if (!harness.LoadChannels())
+    Fail("cannot load the channels");
+}
+
+void Refresh(PlutotvHarness& harness, const Window& window)
+{
+  if (!harness.RefreshEpg(window.start, window.end))
+    Fail("cannot load the EPG");
+}
+
+// runs scenario in a child process and waits for it
+bool Isolated(const function<void()>& scenario)
+{
+  fflush(stdout);
+  const pid_t pid = fork();
+  if (pid < 0)
+    return false;
+  if (pid == 0)
+  {
+    scenario();
+    fflush(stdout);
+    _exit(0);
+  }
+
+  int status;
+  return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// the sscanf / timegm decoder Utils::ParseTime replaced, for time.parse legacy
+time_t LegacyStringToTime(std::string timeString)
+{
+  struct tm tm
+  {
+  };
+
+  int year, month, day, h, m, s, tzh, tzm;
+  if (sscanf(timeString.c_str(), "%d-%d-%dT%d:%d:%d%d", &year, &month, &day, &h, &m, &s, &tzh) < 7)
+  {
+    tzh = 0;
+  }
+  tzm = tzh % 100;
+  tzh = tzh / 100;
+
+  tm.tm_year = year - 1900;
+  tm.tm_mon = month - 1;
+  tm.tm_mday = day;
+  tm.tm_hour = h - tzh;
+  tm.tm_min = m - tzm;
+  tm.tm_sec = s;
+
+  return timegm(&tm);
+}
+
+// a start and a stop per programme, as the EPG response carries them
+vector<string> Timestamps(size_t count)
+{
+  vector<string> timestamps;
+  timestamps.reserve(count);
+  time_t time = 1600000000;
+  for (size_t i = 0; i < count; ++i)
+  {
+    struct tm tm
+    {
+    };
+    gmtime_r(&time, &tm);
+    char buffer[32];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S.000Z", &tm);
+    timestamps.emplace_back(buffer);
+    time += 25 * 60;
+  }
+  return timestamps;
+}
+
+bool ParseOptions(int argc, char* argv[], Options& options)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const string arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (arg == "--channels" && hasValue)
+      options.channels = max(1, atoi(argv[++i]));
+    else if (arg == "--iterations" && hasValue)
+      options.iterations = max(1, atoi(argv[++i]));
+    else if (arg == "--hours" && hasValue)
+      options.hours = {max(1, atoi(argv[++i]))};
+    else if (arg == "--replay" && hasValue)
+      options.replay = argv[++i];
+    else
+    {
+      printf("usage: %s [--channels N] [--hours H] [--iterations N]\n"
+             "          [--replay DIRECTORY]\n\n"
+             "Generates %i channels and %i/%i/%i h EPG windows unless a directory recorded\n"
+             "with http_transport 'record' is given, which then serves an H h window. The EPG\n"
+             "calls start two hours ago, as Kodi's do: record shortly before.\n",
+             argv[0], options.channels, 24, 48, 72);
+      return false;
+    }
+  }
+  return true;
+}
+} // unnamed namespace
+
+void* operator new(size_t size)
+{
+  ++g_allocations;
+  g_allocatedBytes += size;
+  if (void* ptr = malloc(size ? size : 1))
+    return ptr;
+  throw bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+  free(ptr);
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!ParseOptions(argc, argv, options))
+    return 1;
+
+  // the channel snapshot LoadChannelData writes goes here, next to the generated responses
+  const string fixtureDir = "/tmp/plutotv-benchmark-" + to_string(getpid()) + "/";
+  if (mkdir(fixtureDir.c_str(), 0700) != 0)
+    Fail("cannot create " + fixtureDir);
+  kodi::SetBaseUserPath(fixtureDir);
+  vector<string> fixtures = {Utils::GetFilePath(PLUTOTV_CHANNEL_CACHE_FILE)};
+  vector<string> directories = {fixtureDir};
+
+  // the windows GetEPGForChannel asks for two hours into the past
+  const time_t start = time(nullptr) - 7200;
+  vector<Window> windows;
+  for (int hours : options.hours)
+  {
+    Window window{to_string(hours) + "h", options.replay, start,
+                  start + static_cast<time_t>(hours) * 3600};
+    PlutotvHarness::SnapEpgWindow(window.start, window.end);
+    if (!options.replay.empty())
+    {
+      window.label = "recorded";
+      windows.push_back(window);
+      break;
+    }
+
+    window.directory = fixtureDir + window.label + "/";
+    directories.push_back(window.directory);
+    mkdir(window.directory.c_str(), 0700);
+    const string channelsPath = window.directory + CHANNELS_RECORDING;
+    const string epgPath = window.directory + EPG_RECORDING;
+    fixtures.push_back(channelsPath);
+    fixtures.push_back(epgPath);
+    if (!Fixtures::WriteChannels(channelsPath, options.channels) ||
+        !Fixtures::WriteEpg(epgPath, options.channels, window.start, hours))
+      Fail("cannot write fixtures to " + window.directory);
+    windows.push_back(window);
+  }
+  const string& channelsDir = windows.front().directory;
+
+  printf("%-22s %6s %10s %10s %12s %14s %12s\n", "operation", "iters", "min ms", "median ms",
+         "allocs/op", "KiB alloc/op", "peak RSS KiB");
+  printf("(each operation runs in a process of its own, peak RSS is that process's)\n");
+
+  vector<function<void()>> scenarios;
+
+  scenarios.push_back([&] {
+    PlutotvHarness benchmark(Replay(channelsDir));
+    Print(Run("channels.load", options.iterations, [&] { benchmark.ResetChannels(); },
+              [&] { Load(benchmark); }));
+  });
+
+  scenarios.push_back([&] {
+    PlutotvHarness benchmark(Replay(channelsDir));
+    Load(benchmark);
+    const vector<int> uids = benchmark.GetChannelUids();
+    size_t urls = 0;
+    Print(Run("stream.url", options.iterations, nullptr, [&] {
+      for (int uid : uids)
+      {
+        kodi::addon::PVRChannel channel;
+        channel.SetUniqueId(static_cast<unsigned int>(uid));
+        vector<kodi::addon::PVRStreamProperty> properties;
+        if (benchmark.GetData().GetChannelStreamProperties(channel, properties) !=
+            PVR_ERROR_NO_ERROR)
+          Fail("no stream URL for channel " + to_string(uid));
+        urls += properties.front().GetValue().size();
+      }
+    }));
+    printf("  %zu channels, %zu bytes of stream URLs per pass\n", uids.size(),
+           urls / options.iterations);
+  });
+
+  // two per programme of a 72 h window of 300 channels
+  const size_t timestampCount = 2 * 300 * 72 * 60 / 25;
+  scenarios.push_back([&] {
+    const vector<string> timestamps = Timestamps(timestampCount);
+    time_t sum = 0;
+    Print(Run("time.parse legacy", options.iterations, nullptr, [&] {
+      for (const auto& timestamp : timestamps)
+        sum += LegacyStringToTime(timestamp);
+    }));
+  });
+
+  scenarios.push_back([&] {
+    const vector<string> timestamps = Timestamps(timestampCount);
+    const vector<string_view> timestampViews(timestamps.begin(), timestamps.end());
+    vector<time_t> times(timestamps.size());
+    Print(Run("time.parse", options.iterations, nullptr, [&] {
+      if (Utils::ParseTimes(timestampViews.data(), timestampViews.size(), times.data()) !=
+          times.size())
+        Fail("cannot parse timestamps");
+    }));
+  });
+
+  for (const auto& window : windows)
+  {
+    // the first download after a start
+    scenarios.push_back([&] {
+      PlutotvHarness benchmark(Replay(window.directory));
+      Load(benchmark);
+      Print(Run("epg.refresh " + window.label, options.iterations, [&] { benchmark.ResetEpg(); },
+                [&] { Refresh(benchmark, window); }));
+    });
+
+    // the daily full download replacing the stored EPG, compared with it channel by channel
+    scenarios.push_back([&] {
+      PlutotvHarness benchmark(Replay(window.directory));
+      Load(benchmark);
+      Refresh(benchmark, window);
+      Print(Run("epg.update " + window.label, options.iterations, [&] { benchmark.AgeEpg(); },
+                [&] { Refresh(benchmark, window); }));
+    });
+
+    // Kodi asking for every channel; a bucket short of the window, so that crossing into the
+    // next hour while this runs still finds everything stored
+    scenarios.push_back([&] {
+      PlutotvHarness benchmark(Replay(window.directory));
+      Load(benchmark);
+      Refresh(benchmark, window);
+      const vector<int> uids = benchmark.GetChannelUids();
+      size_t tags = 0;
+      Print(Run("epg.channels " + window.label, options.iterations, nullptr, [&] {
+        for (int uid : uids)
+        {
+          kodi::addon::PVREPGTagsResultSet results;
+          if (benchmark.GetData().GetEPGForChannel(uid, window.start,
+                                                   window.end - PLUTOTV_EPG_BUCKET,
+                                                   results) != PVR_ERROR_NO_ERROR)
+            Fail("no EPG for channel " + to_string(uid));
+          tags += results.GetCount();
+        }
+      }));
+      printf("  %zu channels, %zu tags\n", benchmark.GetEpgChannels(), tags / options.iterations);
+    });
+  }
+
+  bool ok = true;
+  for (const auto& scenario : scenarios)
+  {
+    ok = Isolated(scenario);
+    if (!ok)
+      break;
+  }
+
+  for (const auto& path : fixtures)
+    remove(path.c_str());
+  for (auto it = directories.rbegin(); it != directories.rend(); ++it)
+    rmdir(it->c_str());
+  return ok ? 0 : 1;
+}
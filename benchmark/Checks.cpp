@@ -0,0 +1,251 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+// Offline checks of the timestamp decoder and of what PlutotvData sends to
+// the API, run by ctest. The responses come from Fixtures through
+// ReplayTransport, which answers a conditional GET with 304 while the
+// recording is unchanged.
+
+#include "Fixtures.h"
+#include "PlutotvHarness.h"
+#include "ReplayTransport.h"
+#include "Utils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+const char* const CHANNELS_RECORDING = "GET_api.pluto.tv_v2_channels.json.body";
+const char* const EPG_RECORDING = "GET_api.pluto.tv_v2_channels.body";
+
+const int CHANNELS = 20;
+const int HOURS = 24;
+
+int g_failures = 0;
+
+void Check(bool condition, const string& what)
+{
+  printf("%s - %s\n", condition ? "ok" : "FAIL", what.c_str());
+  if (!condition)
+    ++g_failures;
+}
+
+struct LoggedRequest
+{
+  string url;
+  string etag; // sent as If-None-Match
+  int statusCode;
+};
+
+/**
+ * Passes the streamed GETs on and logs the validators they carried
+ */
+class LoggingTransport : public HttpTransport
+{
+public:
+  LoggingTransport(std::unique_ptr<HttpTransport> transport, vector<LoggedRequest>& log)
+    : m_transport(std::move(transport)), m_log(log)
+  {
+  }
+
+  bool Request(const string& action,
+               const string& url,
+               const string& postData,
+               int& statusCode,
+               string& body) override
+  {
+    return m_transport->Request(action, url, postData, statusCode, body);
+  }
+
+  bool GetStream(const string& url,
+                 int& statusCode,
+                 const std::function<void(kodi::vfs::CFile& file)>& reader,
+                 HttpValidators* validators) override
+  {
+    const string etag = validators ? validators->etag : "";
+    const bool result = m_transport->GetStream(url, statusCode, reader, validators);
+    m_log.push_back({url, etag, statusCode});
+    return result;
+  }
+
+private:
+  std::unique_ptr<HttpTransport> m_transport;
+  vector<LoggedRequest>& m_log;
+};
+
+bool IsEpgRequest(const LoggedRequest& request)
+{
+  return request.url.find("/v2/channels?") != string::npos;
+}
+
+/**
+ * Utils::ParseTime against known epoch values of the formats the API sends
+ */
+void CheckParseTime()
+{
+  const struct
+  {
+    const char* input;
+    time_t expected;
+  } cases[] = {
+      {"2020-05-27T15:41:00Z", 1590594060},
+      {"2020-05-27T15:41:00.000Z", 1590594060},
+      {"2020-05-27T15:41:00", 1590594060}, // no zone: UTC
+      {"2019-01-20T15:40:00+0100", 1547995200},
+      {"2019-01-20T15:40:00-0100", 1548002400},
+      {"2019-01-20T15:40:00+01:00", 1547995200},
+      {"1969-07-20T20:17:40Z", -14182940},
+      {"2020-02-29T12:00:00Z", 1582977600},
+      {"2020-03-01T00:00:00.000Z", 1583020800},
+      {"2000-02-29T23:59:59Z", 951868799},
+      {"2100-03-01T00:00:00Z", 4107542400},
+  };
+  for (const auto& c : cases)
+  {
+    time_t time = 0;
+    const bool parsed = Utils::ParseTime(c.input, strlen(c.input), time);
+    Check(parsed && time == c.expected, string("ParseTime ") + c.input);
+  }
+
+  const char* const invalid[] = {"", "2020-05-27", "2020-05-27 15:41:00Z", "2020-13-01T00:00:00Z",
+                                 "2020-05-27T15:41:00X", "2020-05-27T15:41:00+1"};
+  for (const char* input : invalid)
+  {
+    time_t time = 0;
+    Check(!Utils::ParseTime(input, strlen(input), time),
+          string("ParseTime rejects \"") + input + "\"");
+  }
+}
+
+vector<LoggedRequest> EpgRequests(vector<LoggedRequest>& log)
+{
+  vector<LoggedRequest> requests;
+  for (const auto& request : log)
+  {
+    if (IsEpgRequest(request))
+      requests.push_back(request);
+  }
+  log.clear();
+  return requests;
+}
+} // unnamed namespace
+
+int main()
+{
+  CheckParseTime();
+
+  const string directory = "/tmp/plutotv-checks-" + to_string(getpid()) + "/";
+  const string channelsPath = directory + CHANNELS_RECORDING;
+  const string epgPath = directory + EPG_RECORDING;
+  if (mkdir(directory.c_str(), 0700) != 0)
+  {
+    fprintf(stderr, "cannot create %s\n", directory.c_str());
+    return 1;
+  }
+  kodi::SetBaseUserPath(directory);
+
+  time_t start = time(nullptr) - 7200;
+  time_t end = start + HOURS * 3600;
+  PlutotvHarness::SnapEpgWindow(start, end);
+  if (!Fixtures::WriteChannels(channelsPath, CHANNELS) ||
+      !Fixtures::WriteEpg(epgPath, CHANNELS, start, HOURS))
+  {
+    fprintf(stderr, "cannot write fixtures to %s\n", directory.c_str());
+    return 1;
+  }
+
+  vector<LoggedRequest> log;
+  {
+    PlutotvHarness harness(
+        std::unique_ptr<HttpTransport>(new LoggingTransport(
+            std::unique_ptr<HttpTransport>(new ReplayTransport(directory, 0, 0)), log)));
+    Check(harness.LoadChannels(), "channels load");
+
+    // the prefetch on startup
+    Check(harness.RefreshEpg(start, end, true), "first EPG refresh");
+    vector<LoggedRequest> requests = EpgRequests(log);
+    const string etag = harness.GetEpgETag();
+    Check(requests.size() == 1 && requests[0].etag.empty() && requests[0].statusCode == 200,
+          "first EPG refresh downloads the window unconditionally");
+    Check(!etag.empty(), "the ETag of the download is stored");
+    const string url = requests.empty() ? "" : requests[0].url;
+
+    // the next prefetch within the same hour
+    Check(harness.RefreshEpg(start, end, true), "second EPG refresh of the same window");
+    requests = EpgRequests(log);
+    Check(requests.size() == 1 && requests[0].url == url && requests[0].etag == etag,
+          "second EPG refresh of the same window sends the stored ETag");
+    Check(requests.size() == 1 && requests[0].statusCode == 304,
+          "an unchanged schedule is answered with 304");
+
+    // GetEPGForChannel finding the window stored
+    Check(harness.RefreshEpg(start, end), "EPG refresh for a stored window");
+    Check(EpgRequests(log).empty(), "a stored window is served without a request");
+
+    // the prefetch an hour later: the last full download is revalidated, the new hour fetched
+    Check(harness.RefreshEpg(start + PLUTOTV_EPG_BUCKET, end + PLUTOTV_EPG_BUCKET, true),
+          "EPG refresh of the next window");
+    requests = EpgRequests(log);
+    Check(requests.size() == 2 && requests[0].url == url && requests[0].etag == etag &&
+              requests[0].statusCode == 304,
+          "the next window revalidates the last full download");
+    Check(requests.size() == 2 && requests[1].url != url && requests[1].etag.empty(),
+          "the next window downloads its new tail");
+
+    // the schedule changes: one more channel
+    if (!Fixtures::WriteEpg(epgPath, CHANNELS + 1, start, HOURS))
+    {
+      fprintf(stderr, "cannot write fixtures to %s\n", directory.c_str());
+      return 1;
+    }
+    Check(harness.RefreshEpg(start + PLUTOTV_EPG_BUCKET, end + PLUTOTV_EPG_BUCKET, true),
+          "EPG refresh after a schedule change");
+    requests = EpgRequests(log);
+    Check(requests.size() == 1 && requests[0].etag == etag && requests[0].statusCode == 200,
+          "a changed schedule is downloaded again");
+    Check(harness.GetEpgChannels() == CHANNELS + 1, "the changed schedule is stored");
+    const string changedEtag = harness.GetEpgETag();
+    Check(!changedEtag.empty() && changedEtag != etag, "the new ETag is stored");
+
+    Check(harness.RefreshEpg(start + PLUTOTV_EPG_BUCKET, end + PLUTOTV_EPG_BUCKET, true),
+          "EPG refresh after the change");
+    requests = EpgRequests(log);
+    Check(requests.size() == 1 && requests[0].etag == changedEtag &&
+              requests[0].statusCode == 304,
+          "the next refresh revalidates with the new ETag");
+
+    // the added channel is taken off again
+    const string addedChannel = Fixtures::ChannelId(CHANNELS);
+    Check(harness.GetEpgEntries(addedChannel, start) > 0, "the added channel has programmes");
+    if (!Fixtures::WriteEpg(epgPath, CHANNELS, start, HOURS))
+    {
+      fprintf(stderr, "cannot write fixtures to %s\n", directory.c_str());
+      return 1;
+    }
+    Check(harness.RefreshEpg(start + PLUTOTV_EPG_BUCKET, end + PLUTOTV_EPG_BUCKET, true),
+          "EPG refresh after a channel was taken off");
+    Check(harness.GetEpgEntries(addedChannel, start) == 0,
+          "a channel missing from the download keeps none of its programmes in the window");
+  }
+
+  remove(channelsPath.c_str());
+  remove(epgPath.c_str());
+  remove((directory + PLUTOTV_CHANNEL_CACHE_FILE).c_str());
+  rmdir(directory.c_str());
+
+  printf("%s\n", g_failures == 0 ? "all checks passed" : "checks failed");
+  return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "Fixtures.h"
+
+#include <cstdio>
+
+using namespace std;
+
+namespace
+{
+const char* const CATEGORIES[] = {"Kids", "Movies", "Entertainment", "News", "Comedy",
+                                  "Sports", "Crime", "Reality"};
+
+const char* const GENRES[] = {"Children & Family", "Action & Adventure", "Comedy",
+                              "News and Information", "Documentaries", "Sports",
+                              "Crime", "Reality"};
+
+// episodes per series
+const int EPISODES = 12;
+
+// programme lengths in minutes, cycled through per channel
+const int DURATIONS[] = {25, 30, 45, 60, 90, 30, 120, 25};
+
+const char* const DESCRIPTION =
+    "Nesmith hat einen Schnupfen. Max, der glaubt, dass Nesmith Luft verliert und bald platt "
+    "sein wird, glaubt, dass nur eine Banane Nesmith retten kann. Und so machen sich Max, "
+    "Aseefa und Doppy auf die Suche nach dem rettenden Heilmittel.";
+
+string IsoTime(time_t time)
+{
+  struct tm tm
+  {
+  };
+  gmtime_r(&time, &tm);
+
+  char buffer[32];
+  strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S.000Z", &tm);
+  return buffer;
+}
+} // unnamed namespace
+
+string Fixtures::ObjectId(unsigned int kind, unsigned int index)
+{
+  char buffer[25];
+  snprintf(buffer, sizeof(buffer), "5%07x%08x%08x", kind, index * 2654435761u, index);
+  return buffer;
+}
+
+bool Fixtures::WriteChannels(const string& path, int channels)
+{
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file)
+    return false;
+
+  string json = "[";
+  bool ok = true;
+  for (int i = 0; i < channels && ok; ++i)
+  {
+    const string id = ObjectId(1, i);
+    const string images = "https://images.pluto.tv/channels/" + id;
+    if (i > 0)
+      json += ',';
+    json += "{\"_id\":\"" + id + "\",\"slug\":\"channel-" + to_string(i) +
+            "\",\"name\":\"Pluto TV Channel " + to_string(i) + "\",\"hash\":\"#Channel" +
+            to_string(i) + "\",\"number\":" + to_string(100 + i) + ",\"summary\":\"" +
+            DESCRIPTION + "\",\"visibility\":\"everyone\",\"onDemandDescription\":\"\"," +
+            "\"category\":\"" + CATEGORIES[i % 8] +
+            "\",\"plutoOfficeOnly\":false,\"directOnly\":true,\"chatRoomId\":-1,"
+            "\"onDemand\":false,\"cohortMask\":1023,";
+    json += "\"featuredImage\":{\"path\":\"" + images +
+            "/featuredImage.jpg?w=1600&h=900&fm=jpg&q=75&fit=fill&fill=blur\"},";
+    json += "\"thumbnail\":{\"path\":\"" + images +
+            "/thumbnail.jpg?w=660&h=660&fm=jpg&q=75&fit=fill&fill=blur\"},";
+    json += "\"tile\":{\"path\":\"" + images + "/tile.jpg\"},";
+    json += "\"logo\":{\"path\":\"" + images + "/logo.png?w=280&h=80&fm=png&fit=fill\"},";
+    json += "\"colorLogoSVG\":{\"path\":\"" + images + "/colorLogoSVG.svg\"},";
+    json += "\"colorLogoPNG\":{\"path\":\"" + images + "/colorLogoPNG.png\"},";
+    json += "\"solidLogoSVG\":{\"path\":\"" + images + "/solidLogoSVG.svg\"},";
+    json += "\"solidLogoPNG\":{\"path\":\"" + images + "/solidLogoPNG.png\"},";
+    json += "\"featured\":false,\"featuredOrder\":-1,\"favorite\":false,\"isStitched\":true,";
+    json += "\"stitched\":{\"urls\":[{\"type\":\"hls\",\"url\":\"https://service-stitcher."
+            "clusters.pluto.tv/stitch/hls/channel/" +
+            id +
+            "/master.m3u8?advertisingId=&appName=&appVersion=unknown&architecture=&"
+            "buildVersion=&clientTime=&deviceDNT=0&deviceId=unknown&deviceLat=49.9874&"
+            "deviceLon=8.4232&deviceMake=&deviceModel=&deviceType=&deviceVersion=unknown&"
+            "includeExtendedEvents=false&marketingRegion=DE&sid=&userId=\"}],"
+            "\"sessionURL\":\"https://service-stitcher.clusters.pluto.tv/session/.json\"}}";
+    ok = Flush(file, json);
+  }
+  json += ']';
+  ok = ok && Flush(file, json);
+  return fclose(file) == 0 && ok;
+}
+
+bool Fixtures::WriteEpg(const string& path, int channels, time_t start, int hours)
+{
+  FILE* file = fopen(path.c_str(), "wb");
+  if (!file)
+    return false;
+
+  const time_t end = start + static_cast<time_t>(hours) * 3600;
+  string json = "[";
+  bool ok = true;
+  unsigned int timeline = 0;
+  for (int i = 0; i < channels && ok; ++i)
+  {
+    if (i > 0)
+      json += ',';
+    json += "{\"_id\":\"" + ObjectId(1, i) + "\",\"slug\":\"channel-" + to_string(i) +
+            "\",\"name\":\"Pluto TV Channel " + to_string(i) +
+            "\",\"number\":" + to_string(100 + i) + ",\"timelines\":[";
+
+    // the first programme started before the window, like in the live responses
+    time_t programmeStart = start - 60 * (i % 30);
+    for (int j = 0; programmeStart < end; ++j, ++timeline)
+    {
+      const time_t programmeEnd = programmeStart + 60 * DURATIONS[(i + j) % 8];
+      // channels loop a few series of EPISODES episodes each, like the live ones
+      const unsigned int series = i * 4 + (j / EPISODES) % 4;
+      const unsigned int episode = series * EPISODES + j % EPISODES;
+      const string episodeId = ObjectId(3, episode);
+      const string seriesId = ObjectId(4, series);
+      const string title = "Series " + to_string(series) + ": Episode " + to_string(j % EPISODES);
+      const string images = "http://images.pluto.tv/series/" + seriesId;
+      if (j > 0)
+        json += ',';
+      json += "{\"_id\":\"" + ObjectId(2, timeline) + "\",\"start\":\"" +
+              IsoTime(programmeStart) + "\",\"stop\":\"" + IsoTime(programmeEnd) +
+              "\",\"title\":\"" + title + "\",\"episode\":{\"_id\":\"" + episodeId +
+              "\",\"number\":" + to_string(j % EPISODES) + ",\"description\":\"" + title +
+              ". " + DESCRIPTION +
+              "\",\"duration\":" + to_string((programmeEnd - programmeStart) * 1000) +
+              ",\"genre\":\"" + GENRES[(i + j) % 8] +
+              "\",\"subGenre\":\"Entertaining\",\"distributeAs\":{\"AVOD\":true},"
+              "\"clip\":{\"originalReleaseDate\":\"" +
+              IsoTime(programmeStart - 86400 * 365) +
+              "\"},\"rating\":\"FSK-6\",\"name\":\"Episode " + to_string(j) +
+              "\",\"poster\":{\"path\":\"http://images.pluto.tv/assets/images/default/"
+              "vod.poster-default.jpg?w=694&h=1000&fm=jpg&q=75&fit=fill&fill=blur\"},";
+      json += "\"thumbnail\":{\"path\":\"http://s3.amazonaws.com/silo.pluto.tv/origin/"
+              "bluevo/production/" +
+              episodeId + ".jpg?w=440&h=440&fm=jpg&q=75&fit=fill&fill=blur\"},";
+      json += "\"liveBroadcast\":false,\"featuredImage\":{\"path\":\"http://s3.amazonaws.com/"
+              "silo.pluto.tv/origin/bluevo/production/" +
+              episodeId + ".jpg?w=1600&h=900&fm=jpg&q=75&fit=fill&fill=blur\"},";
+      json += "\"series\":{\"_id\":\"" + seriesId + "\",\"name\":\"Series " +
+              to_string(series) + "\",\"type\":\"tv\",\"tile\":{\"path\":\"" + images +
+              "/tile.jpg?w=660&h=660&fm=jpg&q=75&fit=fill&fill=blur\"},\"description\":\"" +
+              DESCRIPTION + "\",\"summary\":\"" + DESCRIPTION +
+              "\",\"featuredImage\":{\"path\":\"" + images +
+              "/featuredImage.jpg?w=1600&h=900&fm=jpg&q=75&fit=fill&fill=blur\"}}}}";
+      programmeStart = programmeEnd;
+    }
+    json += "]}";
+    ok = Flush(file, json);
+  }
+  json += ']';
+  ok = ok && Flush(file, json);
+  return fclose(file) == 0 && ok;
+}
+
+bool Fixtures::Flush(FILE* file, string& json)
+{
+  const bool ok = fwrite(json.data(), 1, json.size(), file) == json.size();
+  json.clear();
+  return ok;
+}
@@ -0,0 +1,42 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <ctime>
+#include <string>
+
+/**
+ * Synthetic API responses shaped like the recorded ones (same nesting, the
+ * same unused fields and string lengths), for when no recording is at hand.
+ * Written channel by channel so that generating them does not show up in the
+ * peak RSS of the benchmark.
+ */
+class Fixtures
+{
+public:
+  /**
+   * Write channels.json with the given number of channels to path
+   */
+  static bool WriteChannels(const std::string& path, int channels);
+
+  /**
+   * Write an all-channel EPG response covering [start, start + hours) for the
+   * same channels as WriteChannels(channels) to path
+   */
+  static bool WriteEpg(const std::string& path, int channels, time_t start, int hours);
+
+  /**
+   * plutotvID of the given channel
+   */
+  static std::string ChannelId(int channel) { return ObjectId(1, channel); }
+
+private:
+  static std::string ObjectId(unsigned int kind, unsigned int index);
+  static bool Flush(FILE* file, std::string& json);
+};
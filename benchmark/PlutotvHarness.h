@@ -0,0 +1,122 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "PlutotvData.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Sets PlutotvData up like Create() does, minus the refresh and prewarm
+ * threads, lets the benchmark and the checks call its load and refresh paths
+ * directly and resets the state a run leaves behind
+ */
+class PlutotvHarness
+{
+public:
+  explicit PlutotvHarness(std::unique_ptr<HttpTransport> transport)
+    : m_data(std::move(transport))
+  {
+  }
+
+  PlutotvData& GetData() { return m_data; }
+
+  /**
+   * Forget the channels, the next load is a first start without a snapshot
+   */
+  void ResetChannels()
+  {
+    std::lock_guard<std::mutex> lock(m_data.m_channelsMutex);
+    std::atomic_store(&m_data.m_channelTable,
+                      std::make_shared<const PlutotvData::PlutotvChannelTable>());
+    m_data.m_channelsValidators = HttpValidators();
+  }
+
+  bool LoadChannels() { return m_data.LoadChannelData(); }
+
+  std::vector<int> GetChannelUids()
+  {
+    std::vector<int> uids;
+    for (const auto& channel : m_data.GetChannelTable()->channels)
+      uids.push_back(channel.iUniqueId);
+    return uids;
+  }
+
+  /**
+   * Forget the EPG, the next refresh is the first download after a start
+   */
+  void ResetEpg()
+  {
+    std::lock_guard<std::mutex> lock(m_data.m_epgRefreshMutex);
+    std::atomic_store(&m_data.m_epgStore, std::shared_ptr<const PlutotvData::PlutotvEpgStore>());
+    m_data.m_epgDownload = PlutotvData::PlutotvEpgDownload();
+    m_data.m_epgStrings = StringPool();
+  }
+
+  /**
+   * Make the stored EPG due for its daily full download, with a response that
+   * changed (no validators, a replayed revalidation would answer 304)
+   */
+  void AgeEpg()
+  {
+    std::lock_guard<std::mutex> lock(m_data.m_epgRefreshMutex);
+    std::shared_ptr<PlutotvData::PlutotvEpgStore> store =
+        std::make_shared<PlutotvData::PlutotvEpgStore>(*m_data.GetEpgStore());
+    store->downloaded -= PLUTOTV_EPG_FULL_REFRESH;
+    std::atomic_store(&m_data.m_epgStore,
+                      std::shared_ptr<const PlutotvData::PlutotvEpgStore>(store));
+    m_data.m_epgDownload.validators = HttpValidators();
+  }
+
+  /**
+   * RefreshEpg as GetEPGForChannel (revalidate false) or the prefetch calls it
+   */
+  bool RefreshEpg(time_t start, time_t end, bool revalidate = false)
+  {
+    std::lock_guard<std::mutex> lock(m_data.m_epgRefreshMutex);
+    return m_data.RefreshEpg(start, end, revalidate) != nullptr;
+  }
+
+  size_t GetEpgChannels() { return m_data.GetEpgStore()->channels.size(); }
+
+  /**
+   * Number of stored programmes of a channel starting at from or later
+   */
+  size_t GetEpgEntries(const std::string& plutotvId, time_t from)
+  {
+    const std::shared_ptr<const PlutotvData::PlutotvEpgStore> store = m_data.GetEpgStore();
+    const auto channel = store->channels.find(plutotvId);
+    if (channel == store->channels.end())
+      return 0;
+    size_t entries = 0;
+    for (const auto& entry : channel->second)
+    {
+      if (entry.startTime >= from)
+        ++entries;
+    }
+    return entries;
+  }
+
+  /**
+   * ETag of the last full EPG download
+   */
+  std::string GetEpgETag()
+  {
+    std::lock_guard<std::mutex> lock(m_data.m_epgRefreshMutex);
+    return m_data.m_epgDownload.validators.etag;
+  }
+
+  static void SnapEpgWindow(time_t& start, time_t& end) { PlutotvData::SnapEpgWindow(start, end); }
+
+private:
+  PlutotvData m_data;
+};
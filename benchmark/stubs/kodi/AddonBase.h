@@ -0,0 +1,135 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+// Minimal stand-in for the Kodi add-on API, just enough for the sources the
+// benchmark links. Settings return their defaults and are not stored, the
+// user path is whatever the benchmark sets with SetBaseUserPath().
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#define ATTRIBUTE_HIDDEN
+
+#define STR_HELPER(x) #x
+#define STR(x) STR_HELPER(x)
+
+// the benchmark constructs PlutotvData itself
+#define ADDONCREATOR(AddonClass)
+
+typedef enum AddonLog
+{
+  ADDON_LOG_DEBUG = 0,
+  ADDON_LOG_INFO = 1,
+  ADDON_LOG_WARNING = 2,
+  ADDON_LOG_ERROR = 3,
+  ADDON_LOG_FATAL = 4
+} AddonLog;
+
+typedef enum ADDON_STATUS
+{
+  ADDON_STATUS_OK,
+  ADDON_STATUS_LOST_CONNECTION,
+  ADDON_STATUS_NEED_RESTART,
+  ADDON_STATUS_NEED_SETTINGS,
+  ADDON_STATUS_UNKNOWN,
+  ADDON_STATUS_PERMANENT_FAILURE,
+  ADDON_STATUS_NOT_IMPLEMENTED
+} ADDON_STATUS;
+
+namespace kodi
+{
+
+inline void Log(const AddonLog loglevel, const char* format, ...)
+{
+  // keep the report readable, debug output would be part of the measurement
+  if (loglevel < ADDON_LOG_WARNING)
+    return;
+
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+inline std::string& BaseUserPath()
+{
+  static std::string path;
+  return path;
+}
+
+inline void SetBaseUserPath(const std::string& path)
+{
+  BaseUserPath() = path;
+}
+
+inline std::string GetBaseUserPath(const std::string& append = "")
+{
+  return BaseUserPath() + append;
+}
+
+inline std::string GetAddonPath(const std::string& append = "")
+{
+  return append;
+}
+
+inline std::string GetSettingString(const std::string& settingName,
+                                    const std::string& defaultValue = "")
+{
+  return defaultValue;
+}
+
+inline void SetSettingString(const std::string& settingName, const std::string& settingValue)
+{
+}
+
+inline bool GetSettingBoolean(const std::string& settingName, bool defaultValue = false)
+{
+  return defaultValue;
+}
+
+inline int GetSettingInt(const std::string& settingName, int defaultValue = 0)
+{
+  return defaultValue;
+}
+
+class CSettingValue
+{
+public:
+  explicit CSettingValue(const std::string& value = "") : m_value(value) {}
+
+  std::string GetString() const { return m_value; }
+  bool GetBoolean() const { return m_value == "true"; }
+  int GetInt() const { return std::atoi(m_value.c_str()); }
+
+private:
+  std::string m_value;
+};
+
+namespace addon
+{
+
+class CAddonBase
+{
+public:
+  virtual ~CAddonBase() = default;
+
+  virtual ADDON_STATUS Create() { return ADDON_STATUS_NOT_IMPLEMENTED; }
+  virtual ADDON_STATUS GetStatus() { return ADDON_STATUS_OK; }
+  virtual ADDON_STATUS SetSetting(const std::string& settingName,
+                                  const kodi::CSettingValue& settingValue)
+  {
+    return ADDON_STATUS_UNKNOWN;
+  }
+};
+
+} // namespace addon
+} // namespace kodi
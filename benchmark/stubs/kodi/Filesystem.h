@@ -0,0 +1,143 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+// Minimal stand-in for kodi::vfs. CFile reads local files; the benchmark
+// serves the API through ReplayTransport, so CURL requests are never opened.
+
+#include "AddonBase.h"
+
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <vector>
+
+typedef enum CURLOptiontype
+{
+  ADDON_CURL_OPTION_OPTION,
+  ADDON_CURL_OPTION_PROTOCOL,
+  ADDON_CURL_OPTION_CREDENTIALS,
+  ADDON_CURL_OPTION_HEADER
+} CURLOptiontype;
+
+typedef enum FilePropertyTypes
+{
+  ADDON_FILE_PROPERTY_RESPONSE_PROTOCOL,
+  ADDON_FILE_PROPERTY_RESPONSE_HEADER,
+  ADDON_FILE_PROPERTY_CONTENT_TYPE,
+  ADDON_FILE_PROPERTY_CONTENT_CHARSET,
+  ADDON_FILE_PROPERTY_MIME_TYPE,
+  ADDON_FILE_PROPERTY_EFFECTIVE_URL
+} FilePropertyTypes;
+
+typedef enum OpenFileFlags
+{
+  ADDON_READ_TRUNCATED = 0x01,
+  ADDON_READ_CHUNKED = 0x02,
+  ADDON_READ_CACHED = 0x04,
+  ADDON_READ_NO_CACHE = 0x08,
+  ADDON_READ_BITRATE = 0x10
+} OpenFileFlags;
+
+namespace kodi
+{
+namespace vfs
+{
+
+class CFile
+{
+public:
+  CFile() = default;
+  CFile(const CFile&) = delete;
+  CFile& operator=(const CFile&) = delete;
+  ~CFile() { Close(); }
+
+  bool OpenFile(const std::string& filename, unsigned int flags = 0)
+  {
+    Close();
+    m_file = fopen(filename.c_str(), "rb");
+    return m_file != nullptr;
+  }
+
+  bool OpenFileForWrite(const std::string& filename, bool overwrite = false)
+  {
+    Close();
+    m_file = fopen(filename.c_str(), "wb");
+    return m_file != nullptr;
+  }
+
+  bool IsOpen() const { return m_file != nullptr; }
+
+  void Close()
+  {
+    if (m_file)
+      fclose(m_file);
+    m_file = nullptr;
+  }
+
+  bool CURLCreate(const std::string& url) { return false; }
+
+  bool CURLAddOption(CURLOptiontype type, const std::string& name, const std::string& value)
+  {
+    return false;
+  }
+
+  bool CURLOpen(unsigned int flags) { return false; }
+
+  std::string GetPropertyValue(FilePropertyTypes type, const std::string& name) const
+  {
+    return "";
+  }
+
+  std::vector<std::string> GetPropertyValues(FilePropertyTypes type, const std::string& name) const
+  {
+    return {};
+  }
+
+  ssize_t Read(void* ptr, size_t size)
+  {
+    if (!m_file)
+      return -1;
+    return static_cast<ssize_t>(fread(ptr, 1, size, m_file));
+  }
+
+  ssize_t Write(const void* ptr, size_t size)
+  {
+    if (!m_file)
+      return -1;
+    return static_cast<ssize_t>(fwrite(ptr, 1, size, m_file));
+  }
+
+private:
+  FILE* m_file = nullptr;
+};
+
+inline bool FileExists(const std::string& filename, bool usecache = false)
+{
+  struct stat st;
+  return stat(filename.c_str(), &st) == 0;
+}
+
+inline bool CreateDirectory(const std::string& path)
+{
+  return mkdir(path.c_str(), 0700) == 0 || FileExists(path);
+}
+
+inline bool DeleteFile(const std::string& filename)
+{
+  return remove(filename.c_str()) == 0;
+}
+
+inline bool RenameFile(const std::string& filename, const std::string& newFileName)
+{
+  return rename(filename.c_str(), newFileName.c_str()) == 0;
+}
+
+} // namespace vfs
+} // namespace kodi
@@ -0,0 +1,12 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+// Stand-in for kodi/General.h; the parts the add-on uses are in AddonBase.h
+
+#include "AddonBase.h"
@@ -0,0 +1,248 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+// Minimal stand-in for the PVR instance API. The value classes keep what is
+// set on them, so filling them in costs what it costs in Kodi; result sets
+// only count what is added. Callbacks into Kodi do nothing.
+
+#include "../AddonBase.h"
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+typedef enum PVR_ERROR
+{
+  PVR_ERROR_NO_ERROR = 0,
+  PVR_ERROR_UNKNOWN = -1,
+  PVR_ERROR_NOT_IMPLEMENTED = -2,
+  PVR_ERROR_SERVER_ERROR = -3,
+  PVR_ERROR_SERVER_TIMEOUT = -4,
+  PVR_ERROR_REJECTED = -5,
+  PVR_ERROR_ALREADY_PRESENT = -6,
+  PVR_ERROR_INVALID_PARAMETERS = -7,
+  PVR_ERROR_RECORDING_RUNNING = -8,
+  PVR_ERROR_FAILED = -9
+} PVR_ERROR;
+
+typedef enum PVR_MENUHOOK_CAT
+{
+  PVR_MENUHOOK_UNKNOWN = -1,
+  PVR_MENUHOOK_ALL = 0,
+  PVR_MENUHOOK_CHANNEL = 1,
+  PVR_MENUHOOK_TIMER = 2,
+  PVR_MENUHOOK_EPG = 3,
+  PVR_MENUHOOK_RECORDING = 4,
+  PVR_MENUHOOK_DELETED_RECORDING = 5,
+  PVR_MENUHOOK_SETTING = 6
+} PVR_MENUHOOK_CAT;
+
+#define EPG_GENRE_USE_STRING 0x100
+
+#define PVR_STREAM_PROPERTY_STREAMURL "streamurl"
+#define PVR_STREAM_PROPERTY_INPUTSTREAM "inputstream"
+#define PVR_STREAM_PROPERTY_ISREALTIMESTREAM "isrealtimestream"
+#define PVR_STREAM_PROPERTY_MIMETYPE "mimetype"
+
+namespace kodi
+{
+namespace addon
+{
+
+class PVRCapabilities
+{
+public:
+  void SetSupportsEPG(bool supportsEPG) {}
+  void SetSupportsTV(bool supportsTV) {}
+  void SetSupportsChannelGroups(bool supportsChannelGroups) {}
+};
+
+class PVRChannel
+{
+public:
+  void SetUniqueId(unsigned int uniqueId) { m_uniqueId = uniqueId; }
+  unsigned int GetUniqueId() const { return m_uniqueId; }
+  void SetIsRadio(bool isRadio) { m_isRadio = isRadio; }
+  void SetChannelNumber(unsigned int channelNumber) { m_channelNumber = channelNumber; }
+  void SetChannelName(const std::string& channelName) { m_channelName = channelName; }
+  void SetIconPath(const std::string& iconPath) { m_iconPath = iconPath; }
+  void SetIsHidden(bool isHidden) { m_isHidden = isHidden; }
+
+private:
+  unsigned int m_uniqueId = 0;
+  bool m_isRadio = false;
+  unsigned int m_channelNumber = 0;
+  std::string m_channelName;
+  std::string m_iconPath;
+  bool m_isHidden = false;
+};
+
+class PVRChannelGroup
+{
+public:
+  void SetGroupName(const std::string& groupName) { m_groupName = groupName; }
+  std::string GetGroupName() const { return m_groupName; }
+  void SetIsRadio(bool isRadio) { m_isRadio = isRadio; }
+  void SetPosition(unsigned int position) { m_position = position; }
+
+private:
+  std::string m_groupName;
+  bool m_isRadio = false;
+  unsigned int m_position = 0;
+};
+
+class PVRChannelGroupMember
+{
+public:
+  void SetGroupName(const std::string& groupName) { m_groupName = groupName; }
+  void SetChannelUniqueId(unsigned int channelUniqueId) { m_channelUniqueId = channelUniqueId; }
+  void SetChannelNumber(unsigned int channelNumber) { m_channelNumber = channelNumber; }
+
+private:
+  std::string m_groupName;
+  unsigned int m_channelUniqueId = 0;
+  unsigned int m_channelNumber = 0;
+};
+
+class PVREPGTag
+{
+public:
+  void SetUniqueBroadcastId(unsigned int uniqueBroadcastId)
+  {
+    m_uniqueBroadcastId = uniqueBroadcastId;
+  }
+  void SetUniqueChannelId(unsigned int uniqueChannelId) { m_uniqueChannelId = uniqueChannelId; }
+  void SetTitle(const std::string& title) { m_title = title; }
+  void SetStartTime(time_t startTime) { m_startTime = startTime; }
+  void SetEndTime(time_t endTime) { m_endTime = endTime; }
+  void SetPlot(const std::string& plot) { m_plot = plot; }
+  void SetGenreType(int genreType) { m_genreType = genreType; }
+  void SetGenreDescription(const std::string& genreDescription)
+  {
+    m_genreDescription = genreDescription;
+  }
+  void SetIconPath(const std::string& iconPath) { m_iconPath = iconPath; }
+
+private:
+  unsigned int m_uniqueBroadcastId = 0;
+  unsigned int m_uniqueChannelId = 0;
+  std::string m_title;
+  time_t m_startTime = 0;
+  time_t m_endTime = 0;
+  std::string m_plot;
+  int m_genreType = 0;
+  std::string m_genreDescription;
+  std::string m_iconPath;
+};
+
+class PVRStreamProperty
+{
+public:
+  PVRStreamProperty(const std::string& name, const std::string& value)
+    : m_name(name), m_value(value)
+  {
+  }
+
+  const std::string& GetName() const { return m_name; }
+  const std::string& GetValue() const { return m_value; }
+
+private:
+  std::string m_name;
+  std::string m_value;
+};
+
+class PVRMenuhook
+{
+public:
+  PVRMenuhook(unsigned int hookId, unsigned int localizedStringId, PVR_MENUHOOK_CAT category)
+    : m_hookId(hookId)
+  {
+  }
+
+  unsigned int GetHookId() const { return m_hookId; }
+
+private:
+  unsigned int m_hookId;
+};
+
+class PVRTimerType
+{
+};
+
+template<typename Tag>
+class PVRResultSet
+{
+public:
+  void Add(const Tag& tag) { ++m_count; }
+  size_t GetCount() const { return m_count; }
+
+private:
+  size_t m_count = 0;
+};
+
+typedef PVRResultSet<PVRChannel> PVRChannelsResultSet;
+typedef PVRResultSet<PVRChannelGroup> PVRChannelGroupsResultSet;
+typedef PVRResultSet<PVRChannelGroupMember> PVRChannelGroupMembersResultSet;
+typedef PVRResultSet<PVREPGTag> PVREPGTagsResultSet;
+
+class CInstancePVRClient
+{
+public:
+  virtual ~CInstancePVRClient() = default;
+
+  virtual PVR_ERROR GetCapabilities(PVRCapabilities& capabilities)
+  {
+    return PVR_ERROR_NOT_IMPLEMENTED;
+  }
+  virtual PVR_ERROR GetBackendName(std::string& name) { return PVR_ERROR_NOT_IMPLEMENTED; }
+  virtual PVR_ERROR GetBackendVersion(std::string& version) { return PVR_ERROR_NOT_IMPLEMENTED; }
+  virtual PVR_ERROR GetConnectionString(std::string& connection)
+  {
+    return PVR_ERROR_NOT_IMPLEMENTED;
+  }
+  virtual PVR_ERROR GetChannelsAmount(int& amount) { return PVR_ERROR_NOT_IMPLEMENTED; }
+  virtual PVR_ERROR GetChannels(bool radio, PVRChannelsResultSet& results)
+  {
+    return PVR_ERROR_NOT_IMPLEMENTED;
+  }
+  virtual PVR_ERROR GetChannelGroupsAmount(int& amount) { return PVR_ERROR_NOT_IMPLEMENTED; }
+  virtual PVR_ERROR GetChannelGroups(bool radio, PVRChannelGroupsResultSet& results)
+  {
+    return PVR_ERROR_NOT_IMPLEMENTED;
+  }
+  virtual PVR_ERROR GetChannelGroupMembers(const PVRChannelGroup& group,
+                                           PVRChannelGroupMembersResultSet& results)
+  {
+    return PVR_ERROR_NOT_IMPLEMENTED;
+  }
+  virtual PVR_ERROR GetChannelStreamProperties(const PVRChannel& channel,
+                                               std::vector<PVRStreamProperty>& properties)
+  {
+    return PVR_ERROR_NOT_IMPLEMENTED;
+  }
+  virtual PVR_ERROR GetEPGForChannel(int channelUid,
+                                     time_t start,
+                                     time_t end,
+                                     PVREPGTagsResultSet& results)
+  {
+    return PVR_ERROR_NOT_IMPLEMENTED;
+  }
+  virtual PVR_ERROR CallSettingsMenuHook(const PVRMenuhook& menuhook)
+  {
+    return PVR_ERROR_NOT_IMPLEMENTED;
+  }
+
+  void AddMenuHook(const PVRMenuhook& hook) {}
+  void TriggerChannelUpdate() {}
+  void TriggerChannelGroupsUpdate() {}
+  void TriggerEpgUpdate(unsigned int channelUid) {}
+};
+
+} // namespace addon
+} // namespace kodi
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "BroadcastIds.h"
+
+using namespace std;
+
+int BroadcastIds::Hash(const PlutotvObjectId& timelineId)
+{
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (uint8_t byte : timelineId)
+    hash = (hash ^ byte) * 16777619u;
+
+  // 0 is no id for Kodi
+  const int id = static_cast<int>(hash & 0x7fffffff);
+  return id != 0 ? id : 1;
+}
+
+int BroadcastIds::Get(const PlutotvObjectId& timelineId)
+{
+  const auto collision = m_collisions.find(timelineId);
+  int id = collision != m_collisions.end() ? collision->second : Hash(timelineId);
+
+  while (true)
+  {
+    const auto owner = m_owners.find(id);
+    if (owner == m_owners.end())
+    {
+      m_owners.emplace(id, Owner{timelineId, m_generation});
+      break;
+    }
+    if (owner->second.timelineId == timelineId)
+    {
+      owner->second.generation = m_generation;
+      break;
+    }
+    id = id == 0x7fffffff ? 1 : id + 1;
+  }
+
+  if (id != Hash(timelineId))
+    m_collisions[timelineId] = id;
+  return id;
+}
+
+void BroadcastIds::Sweep()
+{
+  for (auto owner = m_owners.begin(); owner != m_owners.end();)
+  {
+    if (owner->second.generation == m_generation)
+    {
+      ++owner;
+      continue;
+    }
+
+    const auto collision = m_collisions.find(owner->second.timelineId);
+    if (collision != m_collisions.end() && collision->second == owner->first)
+      m_collisions.erase(collision);
+    owner = m_owners.erase(owner);
+  }
+  ++m_generation;
+}
@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "PlutotvTypes.h"
+
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+
+/**
+ * Hands out Kodi broadcast ids for timelines. An id is a hash of the
+ * timeline's ObjectId, so the same programme keeps its id over refreshes
+ * and restarts; the rare timeline whose hash is taken by another one gets
+ * the next free id and keeps that for as long as it is in use.
+ * Not thread-safe.
+ */
+class BroadcastIds
+{
+public:
+  /**
+   * Positive id of timelineId, marking it as in use
+   */
+  int Get(const PlutotvObjectId& timelineId);
+
+  /**
+   * Forget the timelines not asked for since the last Sweep()
+   */
+  void Sweep();
+
+  size_t GetCollisions() const { return m_collisions.size(); }
+
+private:
+  static int Hash(const PlutotvObjectId& timelineId);
+
+  struct Owner
+  {
+    PlutotvObjectId timelineId;
+    unsigned generation;
+  };
+
+  unsigned m_generation = 0;
+  std::unordered_map<int, Owner> m_owners; // id -> timeline
+  std::map<PlutotvObjectId, int> m_collisions; // timelines not on their hash
+};
@@ -0,0 +1,113 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "ChannelsJsonHandler.h"
+
+#include "Utils.h"
+
+using namespace std;
+using namespace rapidjson;
+
+// depth 1: result array, depth 2: channel object
+/*
+  {
+  "_id":"5ad9b648e738977e2c312131",
+  "slug":"aa02",
+  "name":"Pluto TV Kids",
+  "hash":"#KiddiDE",
+  "number":251,
+  "summary":"Lustige Cartoons, Kinderfilme \u0026 Klassiker sowie Filme für die ganze Familie sorgen für jede Menge Spaß und altersgerechte Unterhaltung. Ob für kleine Kids oder ältere Teens, bei Kids ist für jedes Kind und jede Familie garantiert das Richtige dabei.",
+  "visibility":"everyone",
+  "onDemandDescription":"",
+  "category":"Kids",
+  "plutoOfficeOnly":false,
+  "directOnly":true,
+  "chatRoomId":-1,
+  "onDemand":false,
+  "cohortMask":1023,
+  "featuredImage":{ "path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/featuredImage.jpg?w=1600\u0026h=900\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur"},
+  "thumbnail":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/thumbnail.jpg?w=660\u0026h=660\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur" },
+  "tile":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/tile.jpg"},
+  "logo":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/logo.png?w=280\u0026h=80\u0026fm=png\u0026fit=fill"},
+  "colorLogoSVG":{ "path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/colorLogoSVG.svg" },
+  "colorLogoPNG":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/colorLogoPNG.png"},
+  "solidLogoSVG":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/solidLogoSVG.svg" },
+  "solidLogoPNG":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/solidLogoPNG.png"},
+  "featured":false,
+  "featuredOrder":-1,
+  "favorite":false,
+  "isStitched":true,
+  "stitched":{
+     "urls":[{
+           "type":"hls",
+           "url":"https://service-stitcher.clusters.pluto.tv/stitch/hls/channel/5ad9b648e738977e2c312131/master.m3u8?advertisingId=\u0026appName=\u0026appVersion=unknown\u0026architecture=\u0026buildVersion=\u0026clientTime=\u0026deviceDNT=0\u0026deviceId=unknown\u0026deviceLat=49.9874\u0026deviceLon=8.4232\u0026deviceMake=\u0026deviceModel=\u0026deviceType=\u0026deviceVersion=unknown\u0026includeExtendedEvents=false\u0026marketingRegion=DE\u0026sid=\u0026userId="
+        }],
+     "sessionURL":"https://service-stitcher.clusters.pluto.tv/session/.json"
+  }}, */
+
+bool ChannelsJsonHandler::StartObject()
+{
+  if (m_depth == 0)
+    return false;
+
+  Enter();
+  if (m_depth == 2)
+  {
+    m_channel = PlutotvChannel();
+    m_logo.clear();
+    m_colorLogo.clear();
+    m_streamUrl.clear();
+  }
+  return true;
+}
+
+bool ChannelsJsonHandler::EndObject(SizeType memberCount)
+{
+  if (m_depth == 2 && !m_channel.plutotvID.empty())
+  {
+    m_channel.iChannelNumber = static_cast<int>(m_channels.size()) + 1; // position
+    m_channel.iUniqueId = Utils::GetChannelId(m_channel.plutotvID.c_str());
+    m_channel.strIconPath = m_strings.InternUrl(!m_logo.empty() ? m_logo : m_colorLogo);
+    if (!m_streamUrl.empty())
+      m_channel.streamUrl = StreamUrlTemplate(m_streamUrl, m_streamQueries);
+    m_channel.contentHash = m_channel.ComputeHash();
+    m_channels.push_back(std::move(m_channel));
+  }
+  Leave();
+  return true;
+}
+
+bool ChannelsJsonHandler::String(const char* str, SizeType length, bool copy)
+{
+  if (m_depth < 2)
+    return m_depth > 0;
+
+  const string& key = m_keys[m_depth];
+  if (m_depth == 2)
+  {
+    if (key == "_id")
+      m_channel.plutotvID.assign(str, length);
+    else if (key == "name")
+      m_channel.strChannelName.assign(str, length);
+    else if (key == "category")
+      m_channel.strCategory.assign(str, length);
+  }
+  else if (m_depth == 3 && key == "path")
+  {
+    if (m_keys[2] == "logo")
+      m_logo.assign(str, length);
+    else if (m_keys[2] == "colorLogoPNG")
+      m_colorLogo.assign(str, length);
+  }
+  else if (m_depth == 5 && key == "url" && m_keys[2] == "stitched" && m_keys[3] == "urls" &&
+           m_streamUrl.empty())
+  {
+    // the first of "stitched":{"urls":[{"type":"hls","url":...}]}
+    m_streamUrl.assign(str, length);
+  }
+  return true;
+}
@@ -0,0 +1,40 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "JsonSaxHandler.h"
+#include "PlutotvTypes.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * SAX handler for channels.json. Picks the few fields PlutotvChannel needs
+ * while the document streams by, instead of building a DOM of the whole
+ * payload (summaries, images, five logo variants, ...).
+ */
+class ChannelsJsonHandler : public JsonSaxHandler<ChannelsJsonHandler>
+{
+public:
+  std::vector<PlutotvChannel>& GetChannels() { return m_channels; }
+
+  bool StartObject();
+  bool EndObject(rapidjson::SizeType memberCount);
+  bool String(const char* str, rapidjson::SizeType length, bool copy);
+
+private:
+  PlutotvChannel m_channel;
+  std::string m_logo;
+  std::string m_colorLogo;
+  std::string m_streamUrl;
+
+  std::vector<PlutotvChannel> m_channels;
+  std::vector<std::shared_ptr<const StreamUrlTemplate::Query>> m_streamQueries;
+  StringPool m_strings;
+};
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "StringPool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * 64 bit FNV-1a over a sequence of fields, to tell whether a channel or a
+ * timeline changed between two downloads without keeping both around
+ */
+class ContentHash
+{
+public:
+  ContentHash& Add(const char* data, size_t length)
+  {
+    AddBytes(data, length);
+    return Separate();
+  }
+  ContentHash& Add(const std::string& value) { return Add(value.data(), value.size()); }
+  ContentHash& Add(const InternedString& value)
+  {
+    return value ? Add(value->data(), value->size()) : Separate();
+  }
+  ContentHash& Add(const InternedUrl& url)
+  {
+    // the parts hash like the whole URL
+    if (url.m_prefix)
+      AddBytes(url.m_prefix->data(), url.m_prefix->size());
+    AddBytes(url.m_middle.data(), url.m_middle.size());
+    if (url.m_suffix)
+      AddBytes(url.m_suffix->data(), url.m_suffix->size());
+    return Separate();
+  }
+  ContentHash& Add(int64_t value)
+  {
+    for (int i = 0; i < 8; ++i)
+      m_hash = (m_hash ^ static_cast<uint8_t>(value >> (i * 8))) * 1099511628211ull;
+    return *this;
+  }
+
+  uint64_t Get() const { return m_hash; }
+
+private:
+  void AddBytes(const char* data, size_t length)
+  {
+    for (size_t i = 0; i < length; ++i)
+      m_hash = (m_hash ^ static_cast<uint8_t>(data[i])) * 1099511628211ull;
+  }
+  // keeps ("ab", "c") apart from ("a", "bc"); 0xff never occurs in UTF-8
+  ContentHash& Separate()
+  {
+    m_hash = (m_hash ^ 0xff) * 1099511628211ull;
+    return *this;
+  }
+
+  uint64_t m_hash = 14695981039346656037ull;
+};
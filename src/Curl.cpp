@@ -11,6 +11,7 @@
 
 #include "Utils.h"
 
+#include <algorithm>
 #include <utility>
 
 using namespace std;
@@ -71,6 +72,26 @@ string Curl::Get(const string& url, int& statusCode)
   return Request("GET", url, "", statusCode);
 }
 
+bool Curl::Get(const string& url, int& statusCode, string& body)
+{
+  return Request("GET", url, "", statusCode, body);
+}
+
+bool Curl::GetStream(const string& url,
+                     int& statusCode,
+                     const std::function<void(kodi::vfs::CFile& file)>& reader)
+{
+  kodi::vfs::CFile* file = Open("GET", url, "", statusCode);
+  if (file == nullptr)
+    return false;
+
+  // a 304 has no body, the caller keeps what it has
+  if (statusCode != 304)
+    reader(*file);
+  delete file;
+  return true;
+}
+
 string Curl::Post(const string& url, const string& postData, int& statusCode)
 {
   return Request("POST", url, postData, statusCode);
@@ -159,10 +180,10 @@ kodi::vfs::CFile* Curl::PrepareRequest(const string& action,
 }
 
 
-string Curl::Request(const string& action,
-                     const string& url,
-                     const string& postData,
-                     int& statusCode)
+kodi::vfs::CFile* Curl::Open(const string& action,
+                             const string& url,
+                             const string& postData,
+                             int& statusCode)
 {
   int remaining_redirects = redirectLimit;
   location = url;
@@ -175,13 +196,14 @@ string Curl::Request(const string& action,
     if (file == nullptr)
     {
       statusCode = -1;
-      return "";
+      return nullptr;
     }
 
     if (!file->CURLOpen(ADDON_READ_NO_CACHE))
     {
       statusCode = -1;
-      return "";
+      delete file;
+      return nullptr;
     }
 
     statusCode = 200;
@@ -206,25 +228,67 @@ string Curl::Request(const string& action,
       redirect = true;
       kodi::Log(ADDON_LOG_DEBUG, "redirects remaining: %i", remaining_redirects);
       remaining_redirects--;
+      delete file;
       file = PrepareRequest("GET", location.c_str(), "");
     }
   } while (redirect && remaining_redirects >= 0);
 
-  // read the file
-  static const unsigned int CHUNKSIZE = 16384;
-  char buf[CHUNKSIZE + 1];
-  ssize_t nbRead;
-  string body;
-  while ((nbRead = file->Read(buf, CHUNKSIZE)) > 0 && ~nbRead)
+  if (file != nullptr)
   {
-    buf[nbRead] = 0x0;
-    body += buf;
+    etag = file->GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_HEADER, "ETag");
+    lastModified = file->GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_HEADER, "Last-Modified");
   }
+  return file;
+}
 
-  delete file;
+string Curl::Request(const string& action,
+                     const string& url,
+                     const string& postData,
+                     int& statusCode)
+{
+  string body;
+  Request(action, url, postData, statusCode, body);
   return body;
 }
 
+bool Curl::Request(const string& action,
+                   const string& url,
+                   const string& postData,
+                   int& statusCode,
+                   string& body)
+{
+  // body is the caller's buffer: keep its capacity, so reused buffers don't reallocate
+  body.clear();
+
+  kodi::vfs::CFile* file = Open(action, url, postData, statusCode);
+  if (file == nullptr)
+    return false;
+
+  // pre-size from Content-Length (the compressed size with gzip, so only a lower bound)
+  const int contentLength = Utils::stoiDefault(
+      file->GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_HEADER, "Content-Length"), 0);
+  if (contentLength > 0)
+    body.reserve(contentLength);
+
+  // read the file straight into the body, by length, so embedded NULs survive
+  static const size_t CHUNKSIZE = 16384;
+  size_t size = 0;
+  ssize_t nbRead;
+  do
+  {
+    if (body.capacity() < size + CHUNKSIZE)
+      body.reserve(std::max(body.capacity() * 2, size + CHUNKSIZE));
+    body.resize(size + CHUNKSIZE);
+    nbRead = file->Read(&body[size], CHUNKSIZE);
+    if (nbRead > 0)
+      size += nbRead;
+  } while (nbRead > 0);
+  body.resize(size);
+
+  delete file;
+  return true;
+}
+
 
 std::string Curl::Base64Encode(unsigned char const* in, unsigned int in_len, bool urlEncode)
 {
@@ -7,8 +7,11 @@
  *  Originally taken from pvr.zattoo (https://github.com/rbuehlma/pvr.zattoo)
  */
 
+#pragma once
+
 #include "kodi/Filesystem.h"
 
+#include <functional>
 #include <list>
 #include <map>
 #include <string>
@@ -27,21 +30,37 @@ public:
   virtual ~Curl();
   virtual std::string Delete(const std::string& url, const std::string& postData, int& statusCode);
   virtual std::string Get(const std::string& url, int& statusCode);
+  virtual bool Get(const std::string& url, int& statusCode, std::string& body);
+  virtual bool GetStream(const std::string& url,
+                         int& statusCode,
+                         const std::function<void(kodi::vfs::CFile& file)>& reader);
   virtual std::string Post(const std::string& url, const std::string& postData, int& statusCode);
+  virtual bool Request(const std::string& action,
+                       const std::string& url,
+                       const std::string& postData,
+                       int& statusCode,
+                       std::string& body);
   virtual void AddHeader(const std::string& name, const std::string& value);
   virtual void AddOption(const std::string& name, const std::string& value);
   virtual void ResetHeaders();
   virtual std::string GetCookie(const std::string& name);
+  virtual const std::list<Cookie>& GetCookies() const { return cookies; }
   virtual void SetCookie(const std::string& host,
                          const std::string& name,
                          const std::string& value);
   virtual std::string GetLocation() { return location; }
+  virtual std::string GetETag() { return etag; }
+  virtual std::string GetLastModified() { return lastModified; }
   virtual void SetRedirectLimit(int limit) { redirectLimit = limit; }
 
 private:
   virtual kodi::vfs::CFile* PrepareRequest(const std::string& action,
                                            const std::string& url,
                                            const std::string& postData);
+  virtual kodi::vfs::CFile* Open(const std::string& action,
+                                 const std::string& url,
+                                 const std::string& postData,
+                                 int& statusCode);
   virtual void ParseCookies(kodi::vfs::CFile* file, const std::string& host);
   virtual std::string Request(const std::string& action,
                               const std::string& url,
@@ -53,5 +72,7 @@ private:
   std::map<std::string, std::string> options;
   std::list<Cookie> cookies;
   std::string location;
+  std::string etag;
+  std::string lastModified;
   int redirectLimit = 8;
 };
@@ -0,0 +1,46 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "CurlTransport.h"
+
+using namespace std;
+
+CurlTransport::CurlTransport(const string& userAgent) : m_userAgent(userAgent)
+{
+}
+
+bool CurlTransport::Request(
+    const string& action, const string& url, const string& postData, int& statusCode, string& body)
+{
+  return GetSession(url).Request(action, url, postData, statusCode, body);
+}
+
+bool CurlTransport::GetStream(const string& url,
+                              int& statusCode,
+                              const std::function<void(kodi::vfs::CFile& file)>& reader,
+                              HttpValidators* validators)
+{
+  return GetSession(url).GetStream(url, statusCode, reader, validators);
+}
+
+void CurlTransport::Prewarm(const string& url)
+{
+  GetSession(url).Prewarm();
+}
+
+HttpSession& CurlTransport::GetSession(const string& url)
+{
+  size_t end = url.find("://");
+  end = url.find_first_of("/?#", end == string::npos ? 0 : end + 3);
+  const string origin = url.substr(0, end);
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::unique_ptr<HttpSession>& session = m_sessions[origin];
+  if (!session)
+    session.reset(new HttpSession(origin, m_userAgent));
+  return *session;
+}
@@ -0,0 +1,43 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "HttpSession.h"
+#include "HttpTransport.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * Live transport through Kodi's curl, with one HttpSession per host
+ */
+class CurlTransport : public HttpTransport
+{
+public:
+  explicit CurlTransport(const std::string& userAgent);
+
+  bool Request(const std::string& action,
+               const std::string& url,
+               const std::string& postData,
+               int& statusCode,
+               std::string& body) override;
+  bool GetStream(const std::string& url,
+                 int& statusCode,
+                 const std::function<void(kodi::vfs::CFile& file)>& reader,
+                 HttpValidators* validators) override;
+  void Prewarm(const std::string& url) override;
+
+private:
+  HttpSession& GetSession(const std::string& url);
+
+  std::string m_userAgent;
+  std::mutex m_mutex;
+  std::map<std::string, std::unique_ptr<HttpSession>> m_sessions; // by scheme://host[:port]
+};
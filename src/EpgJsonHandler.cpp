@@ -0,0 +1,131 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "EpgJsonHandler.h"
+
+#include "Utils.h"
+
+using namespace std;
+using namespace rapidjson;
+
+// depth 1: result array, 2: channel, 3: "timelines" array, 4: timeline,
+// 5: "episode", 6: "episode"/"thumbnail"
+//    "timelines":[{
+//          "_id":"5eccebf293483f0007d9ae18",
+//          "start":"2020-05-27T15:41:00.000Z",
+//          "stop":"2020-05-27T16:06:00.000Z",
+//          "title":"Planet Max: Die Affengrippe",
+//          "episode":{
+//             "_id":"5d0b449900557a40f64a71ee",
+//             "number":124,
+//             "description":"Nesmith hat einen Schnupfen. Max, der glaubt, dass Nesmith Luft verliert und bald platt sein wird, glaubt, dass nur eine Banane Nesmith retten kann. Und so machen sich Max, Aseefa und Doppy auf die Suche nach dem rettenden Heilmittel.",
+//             "duration":1500000,
+//             "genre":"News and Information",
+//             "subGenre":"Entertaining",
+//             "distributeAs":{ "AVOD":true },
+//             "clip":{  "originalReleaseDate":"2020-05-27T17:53:04.127Z"},
+//             "rating":"FSK-6",
+//             "name":"Die Affengrippe",
+//             "poster":{ "path":"http://images.pluto.tv/assets/images/default/vod.poster-default.jpg?w=694\u0026h=1000\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur" },
+//             "thumbnail":{ "path":"http://s3.amazonaws.com/silo.pluto.tv/origin/bluevo/nickelodeon/production/201906/20/nickelodeon_5d0a5767621cc_Planet-Max-DE-Die-Affengrippe-S1E124_1561019544860.jpg?w=440\u0026h=440\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur" },
+//             "liveBroadcast":false,
+//             "featuredImage":{ "path":"http://s3.amazonaws.com/silo.pluto.tv/origin/bluevo/nickelodeon/production/201906/20/nickelodeon_5d0a5767621cc_Planet-Max-DE-Die-Affengrippe-S1E124_1561019544860.jpg?w=1600\u0026h=900\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur" },
+//             "series":{
+//                "_id":"5d0b449100557a40f64a71ad",
+//                "name":"Planet Max",
+//                "type":"tv",
+//                "tile":{"path":"http://images.pluto.tv/series/5d0b449100557a40f64a71ad/tile.jpg?w=660\u0026h=660\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur" },
+//                "description":"Max, der beste Freund von Jimmy Neutron, schaut sich in Jimmys Labor um u.... Zeenu.",
+//                "summary":"Max, der beste Freund von Jimmy Neut ... chließlich auf dem Planeten Zeenu.",
+//                "featuredImage":{
+//                   "path":"http://images.pluto.tv/series/5d0b449100557a40f64a71ad/featuredImage.jpg?w=1600\u0026h=900\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur"
+//                } }  }   },
+
+bool EpgJsonHandler::StartObject()
+{
+  if (m_depth == 0)
+    return false;
+
+  Enter();
+  if (m_depth == 2)
+  {
+    m_channelId.clear();
+    m_entries.clear();
+  }
+  else if (m_depth == 4 && m_keys[2] == "timelines")
+  {
+    m_entry = PlutotvEpgEntry();
+  }
+  return true;
+}
+
+bool EpgJsonHandler::EndObject(SizeType memberCount)
+{
+  if (m_depth == 4 && m_keys[2] == "timelines")
+  {
+    m_entry.contentHash = m_entry.ComputeHash();
+    m_entries.push_back(std::move(m_entry));
+  }
+  else if (m_depth == 2 && !m_channelId.empty())
+  {
+    // "_id" may follow "timelines", so entries are only filed once the channel is complete
+    std::vector<PlutotvEpgEntry>& entries = m_channels[m_channelId];
+    entries.insert(entries.end(), make_move_iterator(m_entries.begin()),
+                   make_move_iterator(m_entries.end()));
+  }
+  Leave();
+  return true;
+}
+
+bool EpgJsonHandler::String(const char* str, SizeType length, bool copy)
+{
+  if (m_depth < 2)
+    return m_depth > 0;
+
+  const string& key = m_keys[m_depth];
+  if (m_depth == 2)
+  {
+    if (key == "_id")
+      m_channelId.assign(str, length);
+    return true;
+  }
+
+  if (m_depth < 4 || m_keys[2] != "timelines")
+    return true;
+
+  if (m_depth == 4)
+  {
+    if (key == "_id")
+    {
+      if (!Utils::HexToBytes(str, length, m_entry.timelineId.data(), m_entry.timelineId.size()))
+      {
+        // not an ObjectId: fold it in, merging only needs a stable key
+        m_entry.timelineId.fill(0);
+        for (SizeType i = 0; i < length; ++i)
+          m_entry.timelineId[i % 12] = m_entry.timelineId[i % 12] * 31 + str[i];
+      }
+    }
+    else if (key == "title")
+      m_entry.strTitle = m_strings.Intern(str, length);
+    else if (key == "start")
+      Utils::ParseTime(str, length, m_entry.startTime);
+    else if (key == "stop")
+      Utils::ParseTime(str, length, m_entry.endTime);
+  }
+  else if (m_depth == 5 && m_keys[4] == "episode")
+  {
+    if (key == "description")
+      m_entry.strPlot = m_strings.Intern(str, length);
+    else if (key == "genre")
+      m_entry.strGenre = m_strings.Intern(str, length);
+  }
+  else if (m_depth == 6 && m_keys[4] == "episode" && m_keys[5] == "thumbnail" && key == "path")
+  {
+    m_entry.strIconPath = m_strings.InternUrl(str, length);
+  }
+  return true;
+}
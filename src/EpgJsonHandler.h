@@ -0,0 +1,50 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "JsonSaxHandler.h"
+#include "PlutotvTypes.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * SAX handler for the all-channel EPG response. Converts each timeline
+ * into a PlutotvEpgEntry as it streams by and skips everything else
+ * (series metadata, posters, ratings, ...).
+ */
+class EpgJsonHandler : public JsonSaxHandler<EpgJsonHandler>
+{
+public:
+  /**
+   * strings is the pool the titles, plots, genres and thumbnails are interned into
+   */
+  explicit EpgJsonHandler(StringPool& strings) : m_strings(strings) {}
+
+  /**
+   * plutotvID -> entries of that channel, in response order
+   */
+  std::unordered_map<std::string, std::vector<PlutotvEpgEntry>>& GetChannels()
+  {
+    return m_channels;
+  }
+  const StringPool& GetStrings() const { return m_strings; }
+
+  bool StartObject();
+  bool EndObject(rapidjson::SizeType memberCount);
+  bool String(const char* str, rapidjson::SizeType length, bool copy);
+
+private:
+  std::string m_channelId;
+  std::vector<PlutotvEpgEntry> m_entries;
+  PlutotvEpgEntry m_entry;
+
+  std::unordered_map<std::string, std::vector<PlutotvEpgEntry>> m_channels;
+  StringPool& m_strings;
+};
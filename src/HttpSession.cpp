@@ -0,0 +1,108 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "HttpSession.h"
+
+#include "kodi/General.h"
+
+using namespace std;
+
+namespace
+{
+// a connection used more recently than this is still open, no need to prewarm it
+const std::chrono::seconds PREWARM_IDLE(30);
+} // unnamed namespace
+
+HttpSession::HttpSession(const string& origin, const string& userAgent) : m_origin(origin)
+{
+  m_curl.AddHeader("User-Agent", userAgent);
+  m_curl.AddHeader("Connection", "keep-alive");
+}
+
+bool HttpSession::Request(
+    const string& action, const string& url, const string& postData, int& statusCode, string& body)
+{
+  Curl curl = Checkout();
+  const bool result = curl.Request(action, url, postData, statusCode, body);
+  Checkin(curl);
+  return result;
+}
+
+bool HttpSession::GetStream(const string& url,
+                            int& statusCode,
+                            const std::function<void(kodi::vfs::CFile& file)>& reader,
+                            HttpValidators* validators)
+{
+  Curl curl = Checkout();
+  if (validators)
+  {
+    validators->notModified = false;
+    if (!validators->etag.empty())
+      curl.AddHeader("If-None-Match", validators->etag);
+    if (!validators->lastModified.empty())
+      curl.AddHeader("If-Modified-Since", validators->lastModified);
+  }
+
+  const bool result = curl.GetStream(url, statusCode, reader);
+  Checkin(curl);
+
+  if (result && validators)
+  {
+    if (statusCode == 304)
+    {
+      validators->notModified = true;
+    }
+    else
+    {
+      validators->etag = curl.GetETag();
+      validators->lastModified = curl.GetLastModified();
+    }
+  }
+  return result;
+}
+
+bool HttpSession::Prewarm()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_used && std::chrono::steady_clock::now() - m_lastUse < PREWARM_IDLE)
+      return false;
+  }
+
+  // Kodi answers an existence check of an http URL with a HEAD request: the connection is opened
+  // and handed back to the curl pool without a body to download and throw away
+  const auto start = std::chrono::steady_clock::now();
+  const bool reachable = kodi::vfs::FileExists(m_origin + "/", false);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_used = true;
+    m_lastUse = std::chrono::steady_clock::now();
+  }
+  kodi::Log(ADDON_LOG_DEBUG, "[http] prewarmed %s (%s) in %lli ms", m_origin.c_str(),
+            reachable ? "reachable" : "unreachable",
+            static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                       std::chrono::steady_clock::now() - start)
+                                       .count()));
+  return true;
+}
+
+Curl HttpSession::Checkout()
+{
+  // each request gets its own copy, so requests to one host still run in parallel
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_used = true;
+  m_lastUse = std::chrono::steady_clock::now();
+  return m_curl;
+}
+
+void HttpSession::Checkin(const Curl& curl)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_lastUse = std::chrono::steady_clock::now();
+  for (const auto& cookie : curl.GetCookies())
+    m_curl.SetCookie(cookie.host, cookie.name, cookie.value);
+}
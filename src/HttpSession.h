@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "Curl.h"
+#include "HttpTransport.h"
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+
+/**
+ * Requests to one scheme://host. The handles themselves live in Kodi's curl
+ * pool, which hands a released handle (and its open keep-alive connection)
+ * to the next request for the same host. The session keeps that pool fed:
+ * every request asks for keep-alive, carries the cookies the host set
+ * before, and Prewarm() opens the connection ahead of the first real request.
+ */
+class HttpSession
+{
+public:
+  HttpSession(const std::string& origin, const std::string& userAgent);
+
+  bool Request(const std::string& action,
+               const std::string& url,
+               const std::string& postData,
+               int& statusCode,
+               std::string& body);
+  bool GetStream(const std::string& url,
+                 int& statusCode,
+                 const std::function<void(kodi::vfs::CFile& file)>& reader,
+                 HttpValidators* validators);
+
+  /**
+   * Connect (DNS, TCP, TLS) with a HEAD request unless a request did so
+   * recently. Returns whether a connection was opened.
+   */
+  bool Prewarm();
+
+private:
+  Curl Checkout();
+  void Checkin(const Curl& curl);
+
+  std::string m_origin;
+  std::mutex m_mutex;
+  Curl m_curl; // headers and cookies every request starts from
+  std::chrono::steady_clock::time_point m_lastUse;
+  bool m_used = false;
+};
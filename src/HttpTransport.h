@@ -0,0 +1,62 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "kodi/Filesystem.h"
+
+#include <functional>
+#include <string>
+
+/**
+ * Validators of a cached response, sent as If-None-Match / If-Modified-Since
+ * and updated from the response
+ */
+struct HttpValidators
+{
+  std::string etag;
+  std::string lastModified;
+  bool notModified = false; // the server answered 304, the cached data is current
+};
+
+/**
+ * Everything PlutotvData sends over the network goes through this. The
+ * default is CurlTransport, ReplayTransport serves recorded responses.
+ * Implementations are called from several threads at once.
+ */
+class HttpTransport
+{
+public:
+  virtual ~HttpTransport() = default;
+
+  /**
+   * Send the request and store the response body in body. Returns false if
+   * no response arrived at all, statusCode is -1 then.
+   */
+  virtual bool Request(const std::string& action,
+                       const std::string& url,
+                       const std::string& postData,
+                       int& statusCode,
+                       std::string& body) = 0;
+
+  /**
+   * GET url and hand the opened response to reader, which reads the body as
+   * it arrives. Returns false if there was no response to read. With
+   * validators the request is conditional: a 304 sets notModified and skips
+   * reader, any other response stores its validators.
+   */
+  virtual bool GetStream(const std::string& url,
+                         int& statusCode,
+                         const std::function<void(kodi::vfs::CFile& file)>& reader,
+                         HttpValidators* validators) = 0;
+
+  /**
+   * Hint that requests to the host of url will follow: connect ahead of time
+   * if the transport can. Blocks until done.
+   */
+  virtual void Prewarm(const std::string& url) {}
+};
@@ -0,0 +1,74 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "ParseArena.h"
+#include "rapidjson/reader.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Depth and key tracking shared by the SAX handlers of the Pluto.tv API
+ * responses. All of them are a top-level array of objects; Derived only
+ * implements StartObject/EndObject (calling Enter/Leave) and the value
+ * callbacks it cares about, everything else is skipped.
+ */
+template<typename Derived>
+class JsonSaxHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, Derived>
+{
+public:
+  /**
+   * Parse stream; the parser stack lives in arena if one is given
+   */
+  template<typename InputStream>
+  bool Parse(InputStream& stream, ParseArena::Allocator* arena = nullptr)
+  {
+    rapidjson::GenericReader<rapidjson::UTF8<>, rapidjson::UTF8<>, ParseArena::Allocator> reader(
+        arena);
+    return !reader.Parse(stream, static_cast<Derived&>(*this)).IsError() && m_isArray;
+  }
+
+  bool StartArray()
+  {
+    if (m_depth == 0)
+      m_isArray = true;
+    Enter();
+    return true;
+  }
+
+  bool EndArray(rapidjson::SizeType elementCount)
+  {
+    Leave();
+    return true;
+  }
+
+  bool Key(const char* str, rapidjson::SizeType length, bool copy)
+  {
+    m_keys[m_depth].assign(str, length);
+    return true;
+  }
+
+  bool Default() { return m_depth > 0; }
+
+protected:
+  void Enter()
+  {
+    ++m_depth;
+    if (m_keys.size() <= m_depth)
+      m_keys.resize(m_depth + 1);
+    m_keys[m_depth].clear();
+  }
+
+  void Leave() { --m_depth; }
+
+  // m_keys[n] is the last key seen in the object at depth n
+  std::vector<std::string> m_keys;
+  size_t m_depth = 0;
+  bool m_isArray = false;
+};
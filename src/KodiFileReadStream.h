@@ -0,0 +1,97 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "kodi/Filesystem.h"
+
+#include <cassert>
+#include <cstddef>
+
+/**
+ * rapidjson input stream reading straight from an opened kodi::vfs::CFile,
+ * modelled on rapidjson::FileReadStream. Lets the parser consume an HTTP
+ * body chunk by chunk instead of from one string holding the whole response.
+ */
+class KodiFileReadStream
+{
+public:
+  typedef char Ch;
+
+  KodiFileReadStream(kodi::vfs::CFile& file, char* buffer, size_t bufferSize)
+    : m_file(file),
+      m_buffer(buffer),
+      m_bufferSize(bufferSize),
+      m_bufferLast(buffer),
+      m_current(buffer)
+  {
+    assert(bufferSize > 0);
+    Read();
+  }
+
+  Ch Peek() const { return *m_current; }
+  Ch Take()
+  {
+    Ch c = *m_current;
+    Read();
+    return c;
+  }
+  size_t Tell() const { return m_count + static_cast<size_t>(m_current - m_buffer); }
+
+  // not implemented, input only
+  void Put(Ch) { assert(false); }
+  void Flush() { assert(false); }
+  Ch* PutBegin()
+  {
+    assert(false);
+    return 0;
+  }
+  size_t PutEnd(Ch*)
+  {
+    assert(false);
+    return 0;
+  }
+
+private:
+  void Read()
+  {
+    if (m_current < m_bufferLast)
+    {
+      ++m_current;
+      return;
+    }
+    if (m_eof)
+      return;
+
+    m_count += m_readCount;
+    m_current = m_buffer;
+
+    // a short read is no end of stream on network files, only an empty one is
+    const ssize_t nbRead = m_file.Read(m_buffer, m_bufferSize);
+    if (nbRead > 0)
+    {
+      m_readCount = static_cast<size_t>(nbRead);
+      m_bufferLast = m_buffer + m_readCount - 1;
+    }
+    else
+    {
+      m_readCount = 0;
+      m_buffer[0] = '\0';
+      m_bufferLast = m_buffer;
+      m_eof = true;
+    }
+  }
+
+  kodi::vfs::CFile& m_file;
+  char* m_buffer;
+  size_t m_bufferSize;
+  char* m_bufferLast;
+  char* m_current;
+  size_t m_readCount = 0;
+  size_t m_count = 0;
+  bool m_eof = false;
+};
@@ -0,0 +1,35 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "Metrics.h"
+
+#include "kodi/General.h"
+
+void Metrics::Add(const std::string& name, double value)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Stat& stat = m_stats[name];
+  if (stat.count == 0 || value < stat.min)
+    stat.min = value;
+  if (stat.count == 0 || value > stat.max)
+    stat.max = value;
+  stat.total += value;
+  ++stat.count;
+}
+
+void Metrics::Dump() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  kodi::Log(ADDON_LOG_INFO, "[metrics] %i entries", static_cast<int>(m_stats.size()));
+  for (const auto& entry : m_stats)
+  {
+    const Stat& stat = entry.second;
+    kodi::Log(ADDON_LOG_INFO, "[metrics] %s: count=%llu total=%.1f avg=%.2f min=%.2f max=%.2f",
+              entry.first.c_str(), static_cast<unsigned long long>(stat.count), stat.total,
+              stat.total / stat.count, stat.min, stat.max);
+  }
+}
@@ -0,0 +1,63 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+/**
+ * Thread-safe registry of hot-path measurements (latency, bytes, parse
+ * time, cache hits, ...). Every name keeps count, sum, min and max;
+ * Dump() writes them all to the Kodi log.
+ */
+class Metrics
+{
+public:
+  /**
+   * Measures the time until destruction and adds it, in milliseconds, to name
+   */
+  class Timer
+  {
+  public:
+    Timer(Metrics& metrics, const std::string& name)
+      : m_metrics(metrics), m_name(name), m_start(std::chrono::steady_clock::now())
+    {
+    }
+    ~Timer() { m_metrics.Add(m_name, ElapsedMs()); }
+
+    double ElapsedMs() const
+    {
+      return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start)
+          .count();
+    }
+
+  private:
+    Metrics& m_metrics;
+    std::string m_name;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  void Add(const std::string& name, double value);
+  void Increment(const std::string& name) { Add(name, 1); }
+  void Dump() const;
+
+private:
+  struct Stat
+  {
+    uint64_t count = 0;
+    double total = 0;
+    double min = 0;
+    double max = 0;
+  };
+
+  mutable std::mutex m_mutex;
+  std::map<std::string, Stat> m_stats;
+};
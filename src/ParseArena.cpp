@@ -0,0 +1,24 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "ParseArena.h"
+
+#include <algorithm>
+
+ParseArena::ParseArena(size_t chunkSize, size_t readBufferSize)
+  : m_firstChunk(chunkSize),
+    m_readBuffer(readBufferSize),
+    m_allocator(m_firstChunk.data(), m_firstChunk.size(), chunkSize)
+{
+}
+
+void ParseArena::Reset()
+{
+  m_highWaterMark = std::max(m_highWaterMark, m_allocator.Size());
+  // Clear() frees the chunks the pool allocated itself, the user-supplied first one stays
+  m_allocator.Clear();
+}
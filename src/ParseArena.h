@@ -0,0 +1,54 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "rapidjson/allocators.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Long-lived scratch memory of one JSON parse: the HTTP read buffer and a
+ * memory pool for the parser's stack. Reset() returns the pool to its first
+ * chunk instead of freeing it, so refreshes running every hour or so reuse
+ * the same memory instead of churning the Kodi process heap.
+ */
+class ParseArena
+{
+public:
+  typedef rapidjson::MemoryPoolAllocator<> Allocator;
+
+  ParseArena(size_t chunkSize, size_t readBufferSize);
+  ParseArena(const ParseArena&) = delete;
+  ParseArena& operator=(const ParseArena&) = delete;
+
+  Allocator& GetAllocator() { return m_allocator; }
+  char* GetReadBuffer() { return m_readBuffer.data(); }
+  size_t GetReadBufferSize() const { return m_readBuffer.size(); }
+
+  /**
+   * Bytes the pool handed out since the last Reset()
+   */
+  size_t GetUsed() const { return m_allocator.Size(); }
+
+  /**
+   * Most bytes used by any parse so far
+   */
+  size_t GetHighWaterMark() const { return m_highWaterMark; }
+
+  /**
+   * Release every chunk but the first, which is kept for the next parse
+   */
+  void Reset();
+
+private:
+  std::vector<char> m_firstChunk;
+  std::vector<char> m_readBuffer;
+  Allocator m_allocator;
+  size_t m_highWaterMark = 0;
+};
@@ -8,16 +8,21 @@
 
 #include "PlutotvData.h"
 
+#include "ChannelsJsonHandler.h"
+#include "CurlTransport.h"
+#include "EpgJsonHandler.h"
+#include "ReplayTransport.h"
 #include "Utils.h"
 #include "kodi/General.h"
-#include "rapidjson/document.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <ctime>
+#include <random>
 #include <regex>
 
 using namespace std;
-using namespace rapidjson;
 
 
 // BEGIN CURL helpers from zattoo addon:
@@ -38,44 +43,201 @@ string PlutotvData::HttpPost(const string& url, const string& postData)
 
 string PlutotvData::HttpRequest(const string& action, const string& url, const string& postData)
 {
-  Curl curl;
   int statusCode;
+  string content;
 
-  curl.AddHeader("User-Agent", PLUTOTV_USER_AGENT);
-  return HttpRequestToCurl(curl, action, url, postData, statusCode);
+  kodi::Log(ADDON_LOG_DEBUG, "Http-Request: %s %s.", action.c_str(), url.c_str());
+  Metrics::Timer timer(m_metrics, "http.request_ms");
+  m_transport->Request(action, url, postData, statusCode, content);
+  m_metrics.Add("http.request_bytes", static_cast<double>(content.size()));
+  return content;
 }
 
-string PlutotvData::HttpRequestToCurl(
-    Curl& curl, const string& action, const string& url, const string& postData, int& statusCode)
+bool PlutotvData::HttpGetJson(
+    const string& url,
+    const std::function<bool(KodiFileReadStream& stream, ParseArena::Allocator& arena)>& parser,
+    HttpValidators* validators)
 {
-  kodi::Log(ADDON_LOG_DEBUG, "Http-Request: %s %s.", action.c_str(), url.c_str());
-  string content;
-  if (action == "POST")
-  {
-    content = curl.Post(url, postData, statusCode);
-  }
-  else if (action == "DELETE")
+  int statusCode;
+
+  kodi::Log(ADDON_LOG_DEBUG, "Http-Request: GET %s (streamed).", url.c_str());
+
+  // parse while the body arrives, the response is never held as one string
+  Metrics::Timer timer(m_metrics, "http.json_ms");
+  bool parsed = false;
+  size_t bytes = 0;
+  std::unique_ptr<ParseArena> arena = AcquireArena();
+  m_transport->GetStream(
+      url, statusCode,
+      [&parser, &parsed, &bytes, &arena](kodi::vfs::CFile& file) {
+        KodiFileReadStream stream(file, arena->GetReadBuffer(), arena->GetReadBufferSize());
+        parsed = parser(stream, arena->GetAllocator());
+        bytes = stream.Tell();
+      },
+      validators);
+  m_metrics.Add("http.json_bytes", static_cast<double>(bytes));
+  ReleaseArena(std::move(arena));
+
+  if (validators && validators->notModified)
   {
-    content = curl.Delete(url, postData, statusCode);
+    m_metrics.Increment("http.not_modified");
+    if (m_verboseLogging)
+      kodi::Log(ADDON_LOG_DEBUG, "[json] %s: not modified", url.c_str());
+    return true;
   }
-  else
+
+  if (!parsed)
   {
-    content = curl.Get(url, statusCode);
+    m_metrics.Increment("http.errors");
+    kodi::Log(ADDON_LOG_ERROR, "[json] request failed or invalid json (%i) for %s", statusCode,
+              url.c_str());
+    return false;
   }
-  return content;
+  if (m_verboseLogging)
+    kodi::Log(ADDON_LOG_DEBUG, "[json] %s: status %i, %llu bytes in %.1f ms", url.c_str(),
+              statusCode, static_cast<unsigned long long>(bytes), timer.ElapsedMs());
+  return true;
+}
+
+std::unique_ptr<ParseArena> PlutotvData::AcquireArena(void)
+{
+  std::lock_guard<std::mutex> lock(m_arenasMutex);
+  if (m_arenas.empty())
+    return std::unique_ptr<ParseArena>(new ParseArena(m_arenaChunkSize, PLUTOTV_PARSE_READ_BUFFER));
+
+  std::unique_ptr<ParseArena> arena = std::move(m_arenas.back());
+  m_arenas.pop_back();
+  return arena;
+}
+
+void PlutotvData::ReleaseArena(std::unique_ptr<ParseArena> arena)
+{
+  m_metrics.Add("parse.arena_bytes", static_cast<double>(arena->GetUsed()));
+  arena->Reset();
+  if (m_verboseLogging)
+    kodi::Log(ADDON_LOG_DEBUG, "[json] parse arena high-water mark: %llu bytes",
+              static_cast<unsigned long long>(arena->GetHighWaterMark()));
+
+  std::lock_guard<std::mutex> lock(m_arenasMutex);
+  m_arenas.push_back(std::move(arena));
+}
+
+std::unique_ptr<HttpTransport> PlutotvData::CreateTransport(void)
+{
+  std::unique_ptr<HttpTransport> transport(new CurlTransport(PLUTOTV_USER_AGENT));
+
+  const int mode = kodi::GetSettingInt("http_transport", PLUTOTV_TRANSPORT_LIVE);
+  if (mode != PLUTOTV_TRANSPORT_REPLAY && mode != PLUTOTV_TRANSPORT_RECORD)
+    return transport;
+
+  std::string directory = kodi::GetSettingString("replay_path");
+  if (directory.empty())
+    directory = Utils::GetFilePath(PLUTOTV_REPLAY_DIRECTORY);
+
+  return std::unique_ptr<HttpTransport>(new ReplayTransport(
+      directory, kodi::GetSettingInt("replay_latency", 0),
+      kodi::GetSettingInt("replay_failure_rate", 0),
+      mode == PLUTOTV_TRANSPORT_RECORD ? std::move(transport) : nullptr));
 }
 // END CURL helpers from zattoo addon
 
 
+PlutotvData::PlutotvData(std::unique_ptr<HttpTransport> transport)
+  : m_transport(std::move(transport))
+{
+}
+
 ADDON_STATUS PlutotvData::Create()
 {
   kodi::Log(ADDON_LOG_DEBUG, "%s - Creating the pluto.tv PVR add-on", __FUNCTION__);
 
-  LoadChannelData();
+  if (!m_transport)
+    m_transport = CreateTransport();
+
+  // open the API connection before the channel and EPG downloads need it
+  m_prewarmThread = std::thread([this] { m_transport->Prewarm(PLUTOTV_API_URL); });
+
+  m_verboseLogging = kodi::GetSettingBoolean("verbose_logging", false);
+  m_arenaChunkSize =
+      static_cast<size_t>(kodi::GetSettingInt("parse_arena_chunk", PLUTOTV_PARSE_ARENA_CHUNK)) *
+      1024;
+  AddMenuHook(kodi::addon::PVRMenuhook(PLUTOTV_MENUHOOK_METRICS, 30050, PVR_MENUHOOK_SETTING));
+
+  m_epgRefreshInterval =
+      kodi::GetSettingInt("epg_refresh_interval", PLUTOTV_EPG_REFRESH_INTERVAL) * 60;
+  m_channelRefreshInterval =
+      kodi::GetSettingInt("channel_refresh_interval", PLUTOTV_CHANNEL_REFRESH_INTERVAL) * 60;
+  m_refreshJitter = kodi::GetSettingInt("refresh_jitter", PLUTOTV_REFRESH_JITTER);
+
+  bool loadChannels = true;
+  if (LoadChannelCache())
+  {
+    // serve the snapshot right away and revalidate it against the API in the background
+    SetChannelsLoaded();
+  }
+  else if (!kodi::GetSettingBoolean("async_startup", true))
+  {
+    // a failed load is tried again in the background
+    loadChannels = !LoadChannelData();
+    SetChannelsLoaded();
+  }
+  // otherwise don't keep Kodi waiting for the API, GetChannels waits (bounded) for the result
+
+  m_refreshThread = std::thread([this, loadChannels] { RefreshProcess(loadChannels); });
+
   m_curStatus = ADDON_STATUS_OK;
   return m_curStatus;
 }
 
+PlutotvData::~PlutotvData()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_refreshThreadMutex);
+    m_refreshThreadStop = true;
+  }
+  m_refreshThreadCondition.notify_all();
+  if (m_refreshThread.joinable())
+    m_refreshThread.join();
+  if (m_prewarmThread.joinable())
+    m_prewarmThread.join();
+}
+
+bool PlutotvData::RefreshChannels(void)
+{
+  PlutotvDelta delta;
+  const bool loaded = LoadChannelData(&delta);
+  SetChannelsLoaded();
+  if (!loaded || delta.IsEmpty())
+    return loaded;
+
+  TriggerChannelUpdate();
+  TriggerChannelGroupsUpdate();
+  return true;
+}
+
+void PlutotvData::SetChannelsLoaded(void)
+{
+  {
+    // under the mutex, or a waiter could miss the notification
+    std::lock_guard<std::mutex> lock(m_channelsMutex);
+    m_channelsLoaded = true;
+  }
+  m_channelsCondition.notify_all();
+}
+
+std::shared_ptr<const PlutotvData::PlutotvChannelTable> PlutotvData::GetChannelTable(
+    bool waitForLoad)
+{
+  if (waitForLoad && !m_channelsLoaded)
+  {
+    std::unique_lock<std::mutex> lock(m_channelsMutex);
+    if (!m_channelsCondition.wait_for(lock, std::chrono::seconds(PLUTOTV_CHANNEL_LOAD_TIMEOUT),
+                                      [this] { return m_channelsLoaded.load(); }))
+      kodi::Log(ADDON_LOG_DEBUG, "[channels] still loading, answering with current state");
+  }
+  return std::atomic_load(&m_channelTable);
+}
+
 ADDON_STATUS PlutotvData::GetStatus()
 {
   kodi::Log(ADDON_LOG_DEBUG, "pluto.tv function call: [%s]", __FUNCTION__);
@@ -85,6 +247,35 @@ ADDON_STATUS PlutotvData::GetStatus()
 ADDON_STATUS PlutotvData::SetSetting(const std::string& settingName,
                                      const kodi::CSettingValue& settingValue)
 {
+  if (settingName == "internal_deviceid" || settingName == "internal_sid")
+    m_streamIdsValid = false;
+  else if (settingName == "verbose_logging")
+    m_verboseLogging = settingValue.GetBoolean();
+  else if (settingName == "parse_arena_chunk")
+  {
+    // drop the idle arenas, the next downloads create them with the new size
+    std::lock_guard<std::mutex> lock(m_arenasMutex);
+    m_arenaChunkSize = static_cast<size_t>(settingValue.GetInt()) * 1024;
+    m_arenas.clear();
+  }
+  else if (settingName == "epg_refresh_interval" || settingName == "channel_refresh_interval" ||
+           settingName == "refresh_jitter")
+  {
+    if (settingName == "epg_refresh_interval")
+      m_epgRefreshInterval = settingValue.GetInt() * 60;
+    else if (settingName == "channel_refresh_interval")
+      m_channelRefreshInterval = settingValue.GetInt() * 60;
+    else
+      m_refreshJitter = settingValue.GetInt();
+
+    // reschedule
+    std::lock_guard<std::mutex> lock(m_refreshThreadMutex);
+    m_refreshThreadCondition.notify_all();
+  }
+  else if (settingName == "http_transport" || settingName == "replay_path" ||
+           settingName == "replay_latency" || settingName == "replay_failure_rate")
+    return ADDON_STATUS_NEED_RESTART;
+
   return ADDON_STATUS_OK;
 }
 
@@ -92,6 +283,7 @@ PVR_ERROR PlutotvData::GetCapabilities(kodi::addon::PVRCapabilities& capabilitie
 {
   capabilities.SetSupportsEPG(true);
   capabilities.SetSupportsTV(true);
+  capabilities.SetSupportsChannelGroups(true);
 
   return PVR_ERROR_NO_ERROR;
 }
@@ -130,123 +322,281 @@ void PlutotvData::SetStreamProperties(std::vector<kodi::addon::PVRStreamProperty
   properties.emplace_back("inputstream.adaptive.manifest_update_parameter", "full");
 }
 
-bool PlutotvData::LoadChannelData(void)
+bool PlutotvData::LoadChannelData(PlutotvDelta* delta)
 {
   kodi::Log(ADDON_LOG_DEBUG, "[load data] Login valid -> GET CHANNELS");
 
-  string jsonChannels = HttpGet("https://api.pluto.tv/v2/channels.json");
-  if (jsonChannels.size() == 0)
+  // parse channels
+  kodi::Log(ADDON_LOG_DEBUG, "[channels] parse channels");
+  Metrics::Timer timer(m_metrics, "channels.load_ms");
+  HttpValidators validators;
   {
-    kodi::Log(ADDON_LOG_ERROR, "[channels] ERROR - empty response");
-    return PVR_ERROR_SERVER_ERROR;
+    std::lock_guard<std::mutex> lock(m_channelsMutex);
+    if (!GetChannelTable()->channels.empty())
+      validators = m_channelsValidators;
   }
-  jsonChannels = "{\"result\": " + jsonChannels + "}";
-  kodi::Log(ADDON_LOG_DEBUG, "[channels] length: %i;", jsonChannels.length());
-  kodi::Log(ADDON_LOG_DEBUG, "[channels] %s;", jsonChannels.c_str());
-  kodi::Log(ADDON_LOG_DEBUG, "[channels] %s;",
-            jsonChannels.substr(jsonChannels.size() - 40).c_str());
 
-  // parse channels
-  kodi::Log(ADDON_LOG_DEBUG, "[channels] parse channels");
-  Document channelsDoc;
-  channelsDoc.Parse(jsonChannels.c_str());
-  if (channelsDoc.GetParseError())
+  ChannelsJsonHandler handler;
+  if (!HttpGetJson(
+          PLUTOTV_API_URL + "/v2/channels.json",
+          [&handler](KodiFileReadStream& stream, ParseArena::Allocator& arena) {
+            return handler.Parse(stream, &arena);
+          },
+          &validators))
   {
     kodi::Log(ADDON_LOG_ERROR, "[LoadChannelData] ERROR: error while parsing json");
-    return PVR_ERROR_SERVER_ERROR;
-  }
-  kodi::Log(ADDON_LOG_DEBUG, "[channels] iterate channels");
-  kodi::Log(ADDON_LOG_DEBUG, "[channels] size: %i;", channelsDoc["result"].Size());
-
-  int i = 0;
-  for (const auto& channel : channelsDoc["result"].GetArray())
-  {
-    /**
-      {
-      "_id":"5ad9b648e738977e2c312131",
-      "slug":"aa02",
-      "name":"Pluto TV Kids",
-      "hash":"#KiddiDE",
-      "number":251,
-      "summary":"Lustige Cartoons, Kinderfilme \u0026 Klassiker sowie Filme für die ganze Familie sorgen für jede Menge Spaß und altersgerechte Unterhaltung. Ob für kleine Kids oder ältere Teens, bei Kids ist für jedes Kind und jede Familie garantiert das Richtige dabei.",
-      "visibility":"everyone",
-      "onDemandDescription":"",
-      "category":"Kids",
-      "plutoOfficeOnly":false,
-      "directOnly":true,
-      "chatRoomId":-1,
-      "onDemand":false,
-      "cohortMask":1023,
-      "featuredImage":{ "path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/featuredImage.jpg?w=1600\u0026h=900\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur"},
-      "thumbnail":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/thumbnail.jpg?w=660\u0026h=660\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur" },
-      "tile":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/tile.jpg"},
-      "logo":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/logo.png?w=280\u0026h=80\u0026fm=png\u0026fit=fill"},
-      "colorLogoSVG":{ "path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/colorLogoSVG.svg" },
-      "colorLogoPNG":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/colorLogoPNG.png"},
-      "solidLogoSVG":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/solidLogoSVG.svg" },
-      "solidLogoPNG":{"path":"https://images.pluto.tv/channels/5ad9b648e738977e2c312131/solidLogoPNG.png"},
-      "featured":false,
-      "featuredOrder":-1,
-      "favorite":false,
-      "isStitched":true,
-      "stitched":{
-         "urls":[{
-               "type":"hls",
-               "url":"https://service-stitcher.clusters.pluto.tv/stitch/hls/channel/5ad9b648e738977e2c312131/master.m3u8?advertisingId=\u0026appName=\u0026appVersion=unknown\u0026architecture=\u0026buildVersion=\u0026clientTime=\u0026deviceDNT=0\u0026deviceId=unknown\u0026deviceLat=49.9874\u0026deviceLon=8.4232\u0026deviceMake=\u0026deviceModel=\u0026deviceType=\u0026deviceVersion=unknown\u0026includeExtendedEvents=false\u0026marketingRegion=DE\u0026sid=\u0026userId="
-            }],
-         "sessionURL":"https://service-stitcher.clusters.pluto.tv/session/.json"
-      }}, */
-
-    string plutotvid = channel["_id"].GetString();
-    ++i;
-    PlutotvChannel plutotv_channel;
-    plutotv_channel.iChannelNumber = i; // position
-    kodi::Log(ADDON_LOG_DEBUG, "[channel] channelnr(pos): %i;", plutotv_channel.iChannelNumber);
-
-    plutotv_channel.plutotvID = plutotvid;
-    kodi::Log(ADDON_LOG_DEBUG, "[channel] pluto.tv ID: %s;", plutotv_channel.plutotvID.c_str());
-
-    int uniqueId = Utils::GetChannelId(plutotvid.c_str());
-    plutotv_channel.iUniqueId = uniqueId;
-    kodi::Log(ADDON_LOG_DEBUG, "[channel] id: %i;", uniqueId);
-
-    string displayName = channel["name"].GetString();
-    plutotv_channel.strChannelName = displayName;
-    kodi::Log(ADDON_LOG_DEBUG, "[channel] name: %s;", plutotv_channel.strChannelName.c_str());
-
-    string logo = "";
-    if (channel.HasMember("logo"))
+    return false;
+  }
+  if (validators.notModified)
+  {
+    kodi::Log(ADDON_LOG_DEBUG, "[channels] not modified, keeping the loaded channels");
+    return true;
+  }
+
+  std::vector<PlutotvChannel>& channels = handler.GetChannels();
+  kodi::Log(ADDON_LOG_DEBUG, "[channels] size: %i;", static_cast<int>(channels.size()));
+  m_metrics.Add("channels.count", static_cast<double>(channels.size()));
+
+  PlutotvDelta changes;
+  bool saveSnapshot;
+  {
+    std::lock_guard<std::mutex> lock(m_channelsMutex);
+    changes = DiffChannels(channels);
+    saveSnapshot = !changes.IsEmpty() || validators.etag != m_channelsValidators.etag ||
+              validators.lastModified != m_channelsValidators.lastModified;
+    m_channelsValidators = validators;
+    if (!changes.IsEmpty())
+      SetChannels(std::move(channels));
+  }
+  kodi::Log(ADDON_LOG_DEBUG, "[channels] %i added, %i removed, %i changed",
+            static_cast<int>(changes.added), static_cast<int>(changes.removed),
+            static_cast<int>(changes.changed));
+  if (saveSnapshot)
+    SaveChannelCache();
+
+  if (delta)
+    *delta = changes;
+  return true;
+}
+
+PlutotvDelta PlutotvData::DiffChannels(const std::vector<PlutotvChannel>& channels)
+{
+  const std::shared_ptr<const PlutotvChannelTable> table = GetChannelTable();
+  PlutotvDelta delta;
+  size_t kept = 0;
+  for (const auto& channel : channels)
+  {
+    const auto it = table->byPlutotvId.find(channel.plutotvID);
+    if (it == table->byPlutotvId.end())
     {
-      logo = channel["logo"]["path"].GetString();
+      ++delta.added;
+      continue;
     }
-    else if (channel.HasMember("colorLogoPNG"))
+    ++kept;
+    if (table->channels[it->second].contentHash != channel.contentHash)
+      ++delta.changed;
+  }
+  delta.removed = table->channels.size() - kept;
+  return delta;
+}
+
+void PlutotvData::SetChannels(std::vector<PlutotvChannel>&& channels)
+{
+  // m_channelsMutex must be held; the indexes are built together with the list and published
+  // with it, readers keep whichever table they took
+  std::shared_ptr<PlutotvChannelTable> table = std::make_shared<PlutotvChannelTable>();
+  table->channels = std::move(channels);
+  table->byUniqueId.reserve(table->channels.size());
+  table->byPlutotvId.reserve(table->channels.size());
+  for (size_t i = 0; i < table->channels.size(); ++i)
+  {
+    table->byUniqueId.emplace(table->channels[i].iUniqueId, i);
+    table->byPlutotvId.emplace(table->channels[i].plutotvID, i);
+
+    const std::string& category = table->channels[i].strCategory;
+    if (category.empty())
+      continue;
+    const auto group = table->groupsByName.emplace(category, table->groups.size());
+    if (group.second)
+      table->groups.push_back({category, {}});
+    table->groups[group.first->second].members.push_back(i);
+  }
+  std::atomic_store(&m_channelTable, std::shared_ptr<const PlutotvChannelTable>(table));
+}
+
+const PlutotvChannel* PlutotvData::PlutotvChannelTable::Find(int uniqueId) const
+{
+  const auto it = byUniqueId.find(uniqueId);
+  return it != byUniqueId.end() ? &channels[it->second] : nullptr;
+}
+
+/*
+ * Channel snapshot layout: "PLTV" magic, uint32 version, the ETag and
+ * Last-Modified validators of the download, uint32 channel count, then per
+ * channel int32 iUniqueId, int32 iChannelNumber and the five strings
+ * plutotvID, strChannelName, strCategory, strIconPath and the stream URL,
+ * each as uint32 length plus bytes. Integers are stored in host byte order,
+ * the file never leaves the device.
+ */
+static void WriteCacheInt(std::string& buffer, uint32_t value)
+{
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void WriteCacheString(std::string& buffer, const std::string& value)
+{
+  WriteCacheInt(buffer, static_cast<uint32_t>(value.size()));
+  buffer.append(value);
+}
+
+static bool ReadCacheInt(const std::string& buffer, size_t& pos, uint32_t& value)
+{
+  if (buffer.size() - pos < sizeof(value))
+    return false;
+  std::memcpy(&value, buffer.data() + pos, sizeof(value));
+  pos += sizeof(value);
+  return true;
+}
+
+static bool ReadCacheString(const std::string& buffer, size_t& pos, std::string& value)
+{
+  uint32_t length;
+  if (!ReadCacheInt(buffer, pos, length) || buffer.size() - pos < length)
+    return false;
+  value.assign(buffer, pos, length);
+  pos += length;
+  return true;
+}
+
+bool PlutotvData::LoadChannelCache(void)
+{
+  const std::string path = Utils::GetFilePath(PLUTOTV_CHANNEL_CACHE_FILE);
+  if (!kodi::vfs::FileExists(path, true))
+    return false;
+
+  kodi::vfs::CFile file;
+  if (!file.OpenFile(path, ADDON_READ_NO_CACHE))
+  {
+    kodi::Log(ADDON_LOG_ERROR, "[channel cache] failed to open %s", path.c_str());
+    return false;
+  }
+
+  std::string buffer;
+  char buf[16384];
+  ssize_t nbRead;
+  while ((nbRead = file.Read(buf, sizeof(buf))) > 0)
+    buffer.append(buf, nbRead);
+  file.Close();
+
+  size_t pos = 0;
+  uint32_t version;
+  uint32_t count;
+  HttpValidators validators;
+  if (buffer.compare(0, 4, "PLTV") != 0)
+    return false;
+  pos += 4;
+  if (!ReadCacheInt(buffer, pos, version) || version != PLUTOTV_CHANNEL_CACHE_VERSION ||
+      !ReadCacheString(buffer, pos, validators.etag) ||
+      !ReadCacheString(buffer, pos, validators.lastModified) || !ReadCacheInt(buffer, pos, count))
+  {
+    kodi::Log(ADDON_LOG_DEBUG, "[channel cache] ignoring outdated snapshot");
+    return false;
+  }
+
+  // the two integers and five string lengths of a record with empty strings
+  static const size_t minRecordSize = 7 * sizeof(uint32_t);
+  if (count > (buffer.size() - pos) / minRecordSize)
+  {
+    kodi::Log(ADDON_LOG_ERROR, "[channel cache] truncated snapshot %s", path.c_str());
+    return false;
+  }
+
+  std::vector<PlutotvChannel> channels(count);
+  std::vector<std::shared_ptr<const StreamUrlTemplate::Query>> streamQueries;
+  StringPool strings;
+  for (auto& channel : channels)
+  {
+    uint32_t uniqueId;
+    uint32_t channelNumber;
+    std::string iconPath;
+    std::string streamURL;
+    if (!ReadCacheInt(buffer, pos, uniqueId) || !ReadCacheInt(buffer, pos, channelNumber) ||
+        !ReadCacheString(buffer, pos, channel.plutotvID) ||
+        !ReadCacheString(buffer, pos, channel.strChannelName) ||
+        !ReadCacheString(buffer, pos, channel.strCategory) ||
+        !ReadCacheString(buffer, pos, iconPath) ||
+        !ReadCacheString(buffer, pos, streamURL))
     {
-      logo = channel["colorLogoPNG"]["path"].GetString();
+      kodi::Log(ADDON_LOG_ERROR, "[channel cache] truncated snapshot %s", path.c_str());
+      return false;
     }
+    channel.iUniqueId = static_cast<int>(uniqueId);
+    channel.iChannelNumber = static_cast<int>(channelNumber);
+    channel.strIconPath = strings.InternUrl(iconPath);
+    if (!streamURL.empty())
+      channel.streamUrl = StreamUrlTemplate(streamURL, streamQueries);
+    channel.contentHash = channel.ComputeHash();
+  }
+
+  kodi::Log(ADDON_LOG_DEBUG, "[channel cache] loaded %u channels", count);
 
-    plutotv_channel.strIconPath = logo;
-    kodi::Log(ADDON_LOG_DEBUG, "[channel] logo: %s;", plutotv_channel.strIconPath.c_str());
+  std::lock_guard<std::mutex> lock(m_channelsMutex);
+  SetChannels(std::move(channels));
+  m_channelsValidators = validators;
+  return true;
+}
 
-    // plutotv_channel.strStreamURL
-    if (channel.HasMember("stitched") && channel["stitched"].HasMember("urls") &&
-        channel["stitched"]["urls"].Size() > 0)
+void PlutotvData::SaveChannelCache(void)
+{
+  std::string buffer = "PLTV";
+  {
+    std::lock_guard<std::mutex> lock(m_channelsMutex);
+    const std::shared_ptr<const PlutotvChannelTable> table = GetChannelTable();
+    WriteCacheInt(buffer, PLUTOTV_CHANNEL_CACHE_VERSION);
+    WriteCacheString(buffer, m_channelsValidators.etag);
+    WriteCacheString(buffer, m_channelsValidators.lastModified);
+    WriteCacheInt(buffer, static_cast<uint32_t>(table->channels.size()));
+    for (const auto& channel : table->channels)
     {
-      string streamURL = channel["stitched"]["urls"][0]["url"].GetString();
-      plutotv_channel.strStreamURL = streamURL;
-      kodi::Log(ADDON_LOG_DEBUG, "[channel] streamURL: %s;", streamURL.c_str());
+      WriteCacheInt(buffer, static_cast<uint32_t>(channel.iUniqueId));
+      WriteCacheInt(buffer, static_cast<uint32_t>(channel.iChannelNumber));
+      WriteCacheString(buffer, channel.plutotvID);
+      WriteCacheString(buffer, channel.strChannelName);
+      WriteCacheString(buffer, channel.strCategory);
+      WriteCacheString(buffer, channel.strIconPath.Get());
+      WriteCacheString(buffer, channel.streamUrl.GetUrl());
     }
+  }
+
+  // write next to the snapshot and rename, so a crash never leaves a torn file behind
+  const std::string path = Utils::GetFilePath(PLUTOTV_CHANNEL_CACHE_FILE);
+  const std::string tmpPath = path + ".tmp";
+  kodi::vfs::CreateDirectory(Utils::GetFilePath(""));
 
-    m_channels.push_back(plutotv_channel);
+  kodi::vfs::CFile file;
+  if (!file.OpenFileForWrite(tmpPath, true))
+  {
+    kodi::Log(ADDON_LOG_ERROR, "[channel cache] failed to write %s", tmpPath.c_str());
+    return;
   }
+  const bool written =
+      file.Write(buffer.data(), buffer.size()) == static_cast<ssize_t>(buffer.size());
+  file.Close();
 
-  return true;
+  if (!written || !kodi::vfs::RenameFile(tmpPath, path))
+  {
+    kodi::Log(ADDON_LOG_ERROR, "[channel cache] failed to store %s", path.c_str());
+    kodi::vfs::DeleteFile(tmpPath);
+  }
 }
 
+
+
 PVR_ERROR PlutotvData::GetChannelsAmount(int& amount)
 {
   kodi::Log(ADDON_LOG_DEBUG, "pluto.tv function call: [%s]", __FUNCTION__);
 
-  amount = m_channels.size();
+  amount = static_cast<int>(GetChannelTable(true)->channels.size());
   return PVR_ERROR_NO_ERROR;
 }
 
@@ -254,7 +604,8 @@ PVR_ERROR PlutotvData::GetChannels(bool radio, kodi::addon::PVRChannelsResultSet
 {
   kodi::Log(ADDON_LOG_DEBUG, "pluto.tv function call: [%s]", __FUNCTION__);
 
-  for (const auto& channel : m_channels)
+  const std::shared_ptr<const PlutotvChannelTable> table = GetChannelTable(true);
+  for (const auto& channel : table->channels)
   {
     if (!radio)
     {
@@ -264,7 +615,7 @@ PVR_ERROR PlutotvData::GetChannels(bool radio, kodi::addon::PVRChannelsResultSet
       kodiChannel.SetIsRadio(false);
       kodiChannel.SetChannelNumber(channel.iChannelNumber);
       kodiChannel.SetChannelName(channel.strChannelName);
-      kodiChannel.SetIconPath(channel.strIconPath);
+      kodiChannel.SetIconPath(channel.strIconPath.Get());
       kodiChannel.SetIsHidden(false);
 
       results.Add(kodiChannel);
@@ -276,6 +627,7 @@ PVR_ERROR PlutotvData::GetChannels(bool radio, kodi::addon::PVRChannelsResultSet
 PVR_ERROR PlutotvData::GetChannelStreamProperties(
     const kodi::addon::PVRChannel& channel, std::vector<kodi::addon::PVRStreamProperty>& properties)
 {
+  Metrics::Timer timer(m_metrics, "stream.url_ms");
   string strUrl = GetChannelStreamUrl(channel.GetUniqueId());
   kodi::Log(ADDON_LOG_DEBUG, "Stream URL -> %s", strUrl.c_str());
   PVR_ERROR ret = PVR_ERROR_FAILED;
@@ -301,218 +653,552 @@ string PlutotvData::GetSettingsUUID(string setting)
 
 string PlutotvData::GetChannelStreamUrl(int uniqueId)
 {
-  for (const auto& thisChannel : m_channels)
+  if (!m_streamIdsValid)
   {
-    if (thisChannel.iUniqueId == (int)uniqueId)
+    // first zap or changed in settings: ask Kodi once, not on every zap. A zap racing this one
+    // waits for the ids instead of filling in empty ones.
+    std::lock_guard<std::mutex> lock(m_settingsMutex);
+    if (!m_streamIdsValid)
     {
-      kodi::Log(ADDON_LOG_DEBUG, "Get live url for channel %s", thisChannel.strChannelName.c_str());
-
-      string streamURL = thisChannel.strStreamURL;
-      kodi::Log(ADDON_LOG_DEBUG, "URL source: %s", streamURL.c_str());
-
-
-      if (Utils::ends_with(streamURL, "?deviceType="))
-      {
-        // lazy approach by plugin.video.plutotv
-        streamURL = Utils::ReplaceAll(
-            streamURL, "deviceType=",
-            "deviceType=&deviceMake=&deviceModel=&&deviceVersion=unknown&appVersion=unknown&"
-            "deviceDNT=0&userId=&advertisingId=&app_name=&appName=&buildVersion=&appStoreUrl=&"
-            "architecture=&includeExtendedEvents=false");
-      }
-
-      //if 'sid' not in streamURL
-      //streamURL = Utils::ReplaceAll(streamURL,"deviceModel=&","deviceModel=&sid="+PLUTOTV_SID+"&deviceId="+PLUTOTV_DEVICEID+"&");
-      streamURL = Utils::ReplaceAll(streamURL, "deviceId=&",
-                                    "deviceId=" + GetSettingsUUID("internal_deviceid") + "&");
-      streamURL =
-          Utils::ReplaceAll(streamURL, "sid=&", "sid=" + GetSettingsUUID("internal_sid") + "&");
-
-      // generic
-      streamURL = Utils::ReplaceAll(streamURL, "deviceType=&", "deviceType=web&");
-      streamURL = Utils::ReplaceAll(streamURL, "deviceMake=&", "deviceMake=Chrome&");
-      streamURL = Utils::ReplaceAll(streamURL, "deviceModel=&", "deviceModel=Chrome&");
-      streamURL = Utils::ReplaceAll(streamURL, "appName=&", "appName=web&");
-
-      return streamURL;
+      m_deviceId = GetSettingsUUID("internal_deviceid");
+      m_sid = GetSettingsUUID("internal_sid");
+      m_streamIdsValid = true;
     }
   }
-  return "";
+
+  const std::shared_ptr<const PlutotvChannelTable> table = GetChannelTable();
+  const PlutotvChannel* thisChannel = table->Find(uniqueId);
+  if (!thisChannel || thisChannel->streamUrl.IsEmpty())
+    return "";
+
+  kodi::Log(ADDON_LOG_DEBUG, "Get live url for channel %s", thisChannel->strChannelName.c_str());
+  std::lock_guard<std::mutex> lock(m_settingsMutex);
+  return thisChannel->streamUrl.Fill(m_deviceId, m_sid);
 }
 
 PVR_ERROR PlutotvData::GetChannelGroupsAmount(int& amount)
 {
-  amount = static_cast<int>(0);
+  amount = static_cast<int>(GetChannelTable(true)->groups.size());
   return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR PlutotvData::GetChannelGroups(bool radio, kodi::addon::PVRChannelGroupsResultSet& results)
 {
-  return PVR_ERROR_NOT_IMPLEMENTED;
+  if (radio)
+    return PVR_ERROR_NO_ERROR;
+
+  const std::shared_ptr<const PlutotvChannelTable> table = GetChannelTable(true);
+  for (size_t i = 0; i < table->groups.size(); ++i)
+  {
+    kodi::addon::PVRChannelGroup kodiGroup;
+
+    kodiGroup.SetGroupName(table->groups[i].name);
+    kodiGroup.SetIsRadio(false);
+    kodiGroup.SetPosition(static_cast<unsigned int>(i) + 1);
+
+    results.Add(kodiGroup);
+  }
+  return PVR_ERROR_NO_ERROR;
 }
 
 PVR_ERROR PlutotvData::GetChannelGroupMembers(const kodi::addon::PVRChannelGroup& group,
                                               kodi::addon::PVRChannelGroupMembersResultSet& results)
 {
-  return PVR_ERROR_NOT_IMPLEMENTED;
+  const std::shared_ptr<const PlutotvChannelTable> table = GetChannelTable(true);
+  const auto it = table->groupsByName.find(group.GetGroupName());
+  if (it == table->groupsByName.end())
+    return PVR_ERROR_NO_ERROR;
+
+  for (size_t member : table->groups[it->second].members)
+  {
+    const PlutotvChannel& channel = table->channels[member];
+    kodi::addon::PVRChannelGroupMember kodiGroupMember;
+
+    kodiGroupMember.SetGroupName(group.GetGroupName());
+    kodiGroupMember.SetChannelUniqueId(static_cast<unsigned int>(channel.iUniqueId));
+    kodiGroupMember.SetChannelNumber(static_cast<unsigned int>(channel.iChannelNumber));
+
+    results.Add(kodiGroupMember);
+  }
+  return PVR_ERROR_NO_ERROR;
+}
+
+void PlutotvData::SnapEpgWindow(time_t& start, time_t& end)
+{
+  start -= start % PLUTOTV_EPG_BUCKET;
+  if (end % PLUTOTV_EPG_BUCKET != 0)
+    end += PLUTOTV_EPG_BUCKET - end % PLUTOTV_EPG_BUCKET;
 }
 
-PVR_ERROR PlutotvData::GetEPGForChannel(int channelUid,
-                                        time_t start,
-                                        time_t end,
-                                        kodi::addon::PVREPGTagsResultSet& results)
+std::shared_ptr<const PlutotvData::PlutotvEpgStore> PlutotvData::GetEpgStore()
 {
+  return std::atomic_load(&m_epgStore);
+}
+
+size_t PlutotvData::MergeEpg(
+    const PlutotvEpgStore& current,
+    std::unordered_map<std::string, std::vector<PlutotvEpgEntry>>& downloaded,
+    time_t from,
+    time_t to,
+    PlutotvEpgStore& store)
+{
+  size_t dropped = 0;
+  auto append = [&store, &dropped](std::vector<PlutotvEpgEntry>& entries,
+                                   std::vector<PlutotvEpgEntry>& download) {
+    for (auto& entry : download)
+    {
+      if (entry.endTime <= store.start)
+        ++dropped;
+      else
+        entries.push_back(std::move(entry));
+    }
+  };
+
+  for (const auto& epgChannel : current.channels)
+  {
+    auto download = downloaded.find(epgChannel.first);
+
+    // the download answers for whatever starts within from..to: a programme starting there that
+    // it lacks was taken off, also when the whole channel is missing from it. A timeline running
+    // across the edge of from..to is in both, the new one wins.
+    std::vector<PlutotvObjectId> replaced;
+    if (download != downloaded.end())
+    {
+      for (const auto& entry : download->second)
+        replaced.push_back(entry.timelineId);
+      std::sort(replaced.begin(), replaced.end());
+    }
+    std::vector<PlutotvEpgEntry> entries;
+    for (const auto& entry : epgChannel.second)
+    {
+      if (entry.endTime <= store.start || (entry.startTime >= from && entry.startTime < to) ||
+          std::binary_search(replaced.begin(), replaced.end(), entry.timelineId))
+        ++dropped;
+      else
+        entries.push_back(entry);
+    }
+    if (download != downloaded.end())
+    {
+      append(entries, download->second);
+      downloaded.erase(download);
+    }
+    if (!entries.empty())
+      store.channels.emplace(epgChannel.first, std::move(entries));
+  }
+
+  // channels that only show up in the download
+  for (auto& epgChannel : downloaded)
+  {
+    std::vector<PlutotvEpgEntry> entries;
+    append(entries, epgChannel.second);
+    if (!entries.empty())
+      store.channels.emplace(epgChannel.first, std::move(entries));
+  }
+  return dropped;
+}
+
+std::shared_ptr<const PlutotvData::PlutotvEpgStore> PlutotvData::RevalidateEpg(
+    const std::shared_ptr<const PlutotvEpgStore>& current, time_t start)
+{
+  // m_epgRefreshMutex must be held. Refreshes only download what is past the stored window, the
+  // URL of the last full download is what they can ask again whether the schedule changed.
+  if (m_epgDownload.url.empty() ||
+      (m_epgDownload.validators.etag.empty() && m_epgDownload.validators.lastModified.empty()))
+    return current;
+
+  HttpValidators validators = m_epgDownload.validators;
+  EpgJsonHandler handler(m_epgStrings);
+  if (!HttpGetJson(
+          m_epgDownload.url,
+          [&handler](KodiFileReadStream& stream, ParseArena::Allocator& arena) {
+            return handler.Parse(stream, &arena);
+          },
+          &validators))
+  {
+    kodi::Log(ADDON_LOG_ERROR, "[epg] revalidation failed, keeping the stored EPG");
+    return current;
+  }
+  if (validators.notModified)
+  {
+    kodi::Log(ADDON_LOG_DEBUG, "[epg] not modified, keeping the stored EPG");
+    return current;
+  }
+  m_epgDownload.validators = validators;
+
+  std::shared_ptr<PlutotvEpgStore> store = std::make_shared<PlutotvEpgStore>();
+  store->start = start;
+  store->end = current->end;
+  store->downloaded = current->downloaded; // the extensions are as old as they were
+  const size_t dropped =
+      MergeEpg(*current, handler.GetChannels(), m_epgDownload.start, m_epgDownload.end, *store);
+  kodi::Log(ADDON_LOG_DEBUG, "[epg] revalidated, replaced %i entries", static_cast<int>(dropped));
+  m_metrics.Increment("epg.revalidated");
+  return PublishEpg(current, store);
+}
+
+std::shared_ptr<const PlutotvData::PlutotvEpgStore> PlutotvData::RefreshEpg(time_t start,
+                                                                            time_t end,
+                                                                            bool revalidate)
+{
+  // m_epgRefreshMutex must be held
+  Metrics::Timer timer(m_metrics, "epg.refresh_ms");
   const time_t now = std::time(nullptr);
-  if (start < now)
+  std::shared_ptr<const PlutotvEpgStore> current = GetEpgStore();
+
+  // while the stored window reaches into the requested one only its tail is missing
+  const bool extend = current && current->start <= start && current->end >= start &&
+                      now - current->downloaded < PLUTOTV_EPG_FULL_REFRESH;
+  if (extend && revalidate)
+    current = RevalidateEpg(current, start);
+  if (extend && current->end >= end)
+    return current;
+  const time_t fetchStart = extend ? current->end : start;
+
+  string url = PLUTOTV_API_URL + "/v2/channels?start=" + Utils::TimeToString(fetchStart) +
+               "&stop=" + Utils::TimeToString(end);
+
+  HttpValidators validators;
+  if (!extend && current && url == m_epgDownload.url)
+    validators = m_epgDownload.validators;
+
+  const size_t hits = m_epgStrings.GetHits();
+  EpgJsonHandler handler(m_epgStrings);
+  if (!HttpGetJson(
+          url,
+          [&handler](KodiFileReadStream& stream, ParseArena::Allocator& arena) {
+            return handler.Parse(stream, &arena);
+          },
+          extend ? nullptr : &validators))
   {
-    kodi::Log(ADDON_LOG_DEBUG, "[epg] adjusting start time to 'now' minus 3 hrs");
-    start = now - 7200; // Pluto.tv API returns nothing if we step back (to wide) in time.
+    kodi::Log(ADDON_LOG_ERROR, "[GetEPG] ERROR: error while parsing json");
+    return nullptr;
+  }
+  if (validators.notModified && current)
+  {
+    kodi::Log(ADDON_LOG_DEBUG, "[epg] not modified, keeping the stored EPG");
+    return current;
+  }
+  if (!extend)
+    m_epgDownload = {url, start, end, validators};
+
+  std::shared_ptr<PlutotvEpgStore> store = std::make_shared<PlutotvEpgStore>();
+  store->start = start;
+  store->end = end;
+  store->downloaded = extend ? current->downloaded : now;
+  if (extend)
+  {
+    const size_t dropped = MergeEpg(*current, handler.GetChannels(), fetchStart, end, *store);
+    kodi::Log(ADDON_LOG_DEBUG, "[epg] extended by %i s, dropped %i expired or replaced entries",
+              static_cast<int>(end - fetchStart), static_cast<int>(dropped));
+    m_metrics.Increment("epg.extend");
   }
+  else
+  {
+    store->channels = std::move(handler.GetChannels());
+  }
+
+  kodi::Log(ADDON_LOG_DEBUG, "[epg] size: %i; %i distinct strings, %i shared",
+            static_cast<int>(store->channels.size()),
+            static_cast<int>(handler.GetStrings().GetSize()),
+            static_cast<int>(handler.GetStrings().GetHits() - hits));
+  return PublishEpg(current, store);
+}
+
+std::shared_ptr<const PlutotvData::PlutotvEpgStore> PlutotvData::PublishEpg(
+    const std::shared_ptr<const PlutotvEpgStore>& current,
+    const std::shared_ptr<PlutotvEpgStore>& store)
+{
+  // m_epgRefreshMutex must be held
+
+  // Kodi fetches the schedule past what it knows by itself, only tell it about changes to the
+  // part both stores cover
+  const time_t overlapStart = current ? std::max(current->start, store->start) : 0;
+  const time_t overlapEnd = current ? std::min(current->end, store->end) : 0;
+  static const std::vector<PlutotvEpgEntry> noEntries;
 
-  for (unsigned int iChannelPtr = 0; iChannelPtr < m_channels.size(); iChannelPtr++)
+  size_t entries = 0;
+  std::vector<std::string> changedChannels;
+  for (auto& epgChannel : store->channels)
   {
-    PlutotvChannel& myChannel = m_channels.at(iChannelPtr);
-    if (myChannel.iUniqueId != channelUid)
-      continue;
+    entries += epgChannel.second.size();
+    for (auto& entry : epgChannel.second)
+      entry.iUniqueBroadcastId = m_broadcastIds.Get(entry.timelineId);
+    std::sort(epgChannel.second.begin(), epgChannel.second.end(),
+              [](const PlutotvEpgEntry& a, const PlutotvEpgEntry& b) {
+                return a.startTime < b.startTime;
+              });
+    if (current)
+    {
+      const auto before = current->channels.find(epgChannel.first);
+      if (!DiffEpg(before != current->channels.end() ? before->second : noEntries,
+                   epgChannel.second, overlapStart, overlapEnd)
+               .IsEmpty())
+        changedChannels.push_back(epgChannel.first);
+    }
+  }
+  m_broadcastIds.Sweep();
 
-    char startTime[100];
-    std::tm* pstm = std::localtime(&start);
-    // 2020-05-27T15:04:05Z
-    std::strftime(startTime, 32, "%Y-%m-%dT%H:%M:%SZ", pstm);
+  if (current)
+  {
+    for (const auto& epgChannel : current->channels)
+    {
+      if (store->channels.find(epgChannel.first) == store->channels.end() &&
+          !DiffEpg(epgChannel.second, noEntries, overlapStart, overlapEnd).IsEmpty())
+        changedChannels.push_back(epgChannel.first);
+    }
+  }
 
-    char endTime[100];
-    std::tm* petm = std::localtime(&end);
-    // 2020-05-27T15:04:05Z
-    std::strftime(endTime, 32, "%Y-%m-%dT%H:%M:%SZ", petm);
+  std::atomic_store(&m_epgStore, std::shared_ptr<const PlutotvEpgStore>(store));
+  // what only the replaced store still refers to is dropped by the next publish, once it is gone
+  const size_t swept = m_epgStrings.Sweep();
+  kodi::Log(ADDON_LOG_DEBUG,
+            "[epg] stored %i channels, %i entries, %i broadcast id collisions, %i strings dropped",
+            static_cast<int>(store->channels.size()), static_cast<int>(entries),
+            static_cast<int>(m_broadcastIds.GetCollisions()), static_cast<int>(swept));
+  m_metrics.Add("epg.refresh_entries", static_cast<double>(entries));
 
-    string url =
-        "http://api.pluto.tv/v2/channels?start=" + string(startTime) + "&stop=" + string(endTime);
+  if (!changedChannels.empty())
+  {
+    kodi::Log(ADDON_LOG_DEBUG, "[epg] schedule changed on %i channels",
+              static_cast<int>(changedChannels.size()));
+    m_metrics.Add("epg.changed_channels", static_cast<double>(changedChannels.size()));
+    const std::shared_ptr<const PlutotvChannelTable> table = GetChannelTable();
+    for (const auto& plutotvID : changedChannels)
+    {
+      const auto it = table->byPlutotvId.find(plutotvID);
+      if (it != table->byPlutotvId.end())
+        TriggerEpgUpdate(static_cast<unsigned int>(table->channels[it->second].iUniqueId));
+    }
+  }
+  return store;
+}
+
+PlutotvDelta PlutotvData::DiffEpg(const std::vector<PlutotvEpgEntry>& before,
+                                  const std::vector<PlutotvEpgEntry>& after,
+                                  time_t start,
+                                  time_t end)
+{
+  // the timelines within start..end, by _id
+  auto collect = [start, end](const std::vector<PlutotvEpgEntry>& entries) {
+    std::vector<std::pair<PlutotvObjectId, uint64_t>> hashes;
+    for (const auto& entry : entries)
+    {
+      if (entry.endTime > start && entry.startTime < end)
+        hashes.emplace_back(entry.timelineId, entry.contentHash);
+    }
+    std::sort(hashes.begin(), hashes.end());
+    return hashes;
+  };
+  const auto beforeHashes = collect(before);
+  const auto afterHashes = collect(after);
+
+  PlutotvDelta delta;
+  auto a = beforeHashes.begin();
+  auto b = afterHashes.begin();
+  while (a != beforeHashes.end() || b != afterHashes.end())
+  {
+    if (b == afterHashes.end() || (a != beforeHashes.end() && a->first < b->first))
+    {
+      ++delta.removed;
+      ++a;
+    }
+    else if (a == beforeHashes.end() || b->first < a->first)
+    {
+      ++delta.added;
+      ++b;
+    }
+    else
+    {
+      if (a->second != b->second)
+        ++delta.changed;
+      ++a;
+      ++b;
+    }
+  }
+  return delta;
+}
+
+bool PlutotvData::PrefetchEpg(void)
+{
+  std::lock_guard<std::mutex> refreshLock(m_epgRefreshMutex);
+  const time_t now = std::time(nullptr);
+  time_t start = now - 7200;
+  // keep the window wide enough for the calls arriving until the next refresh
+  time_t end = now + m_epgSpan + m_epgRefreshInterval;
+  SnapEpgWindow(start, end);
+  return RefreshEpg(start, end, true) != nullptr;
+}
+
+void PlutotvData::RefreshProcess(bool loadChannels)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  std::mt19937 random(std::random_device{}());
+  std::uniform_real_distribution<double> jitter(-1.0, 1.0);
+
+  // each refresh is due its (jittered) interval after it last ran; startup loads right away. A
+  // failed one is retried after a backoff instead, also when its interval is off.
+  bool channelsLoaded = !loadChannels;
+  int channelsFailures = 0;
+  Clock::time_point channelsRun = Clock::now();
+  double channelsJitter = jitter(random);
+  bool epgPrefetched = false;
+  int epgFailures = 0;
+  Clock::time_point epgRun = Clock::now();
+  double epgJitter = jitter(random);
+
+  auto dueTime = [this](Clock::time_point run, int interval, double factor) {
+    const double seconds = interval * (1.0 + factor * m_refreshJitter / 100.0);
+    return run + std::chrono::seconds(static_cast<int64_t>(seconds));
+  };
+  auto retryInterval = [](int failures) {
+    int seconds = PLUTOTV_REFRESH_RETRY;
+    for (int i = 1; i < failures && seconds < PLUTOTV_REFRESH_RETRY_MAX; ++i)
+      seconds *= 2;
+    return std::min(seconds, PLUTOTV_REFRESH_RETRY_MAX);
+  };
+
+  std::unique_lock<std::mutex> lock(m_refreshThreadMutex);
+  while (!m_refreshThreadStop)
+  {
+    // recomputed after every wake-up, so changed settings apply to the pending refreshes
+    const Clock::time_point now = Clock::now();
+    Clock::time_point epgDue = now;
+    if (epgFailures > 0)
+      epgDue = dueTime(epgRun, retryInterval(epgFailures), epgJitter);
+    else if (epgPrefetched)
+      epgDue = dueTime(epgRun, m_epgRefreshInterval, epgJitter);
+    Clock::time_point channelsDue = now;
+    if (channelsFailures > 0)
+    {
+      channelsDue = dueTime(channelsRun, retryInterval(channelsFailures), channelsJitter);
+    }
+    else if (channelsLoaded)
+    {
+      const int channelInterval = m_channelRefreshInterval;
+      channelsDue = channelInterval > 0 ? dueTime(channelsRun, channelInterval, channelsJitter)
+                                        : Clock::time_point::max();
+    }
 
-    Document epgDoc;
-    if (url == cache_url)
+    if (channelsDue <= now)
     {
-      epgDoc.CopyFrom(cache_document, epgDoc.GetAllocator());
+      lock.unlock();
+      const bool refreshed = RefreshChannels();
+      lock.lock();
+      channelsLoaded = true;
+      channelsFailures = refreshed ? 0 : channelsFailures + 1;
+      channelsRun = Clock::now();
+      channelsJitter = jitter(random);
+      if (!refreshed)
+        kodi::Log(ADDON_LOG_ERROR, "[refresh] channel refresh failed, retrying in %i s",
+                  retryInterval(channelsFailures));
+    }
+    else if (epgDue <= now)
+    {
+      lock.unlock();
+      const bool refreshed = PrefetchEpg();
+      lock.lock();
+      epgPrefetched = true;
+      epgFailures = refreshed ? 0 : epgFailures + 1;
+      epgRun = Clock::now();
+      epgJitter = jitter(random);
+      if (!refreshed)
+        kodi::Log(ADDON_LOG_ERROR, "[refresh] EPG prefetch failed, retrying in %i s",
+                  retryInterval(epgFailures));
     }
     else
     {
-      string jsonEpg = HttpGet(url);
-      kodi::Log(ADDON_LOG_DEBUG, "[epg-all] %s", jsonEpg.c_str());
-      if (jsonEpg.size() == 0)
-      {
-        kodi::Log(ADDON_LOG_ERROR, "[epg] empty server response");
-        return PVR_ERROR_SERVER_ERROR;
-      }
-      jsonEpg = "{\"result\": " + jsonEpg + "}";
-
-      epgDoc.Parse(jsonEpg.c_str());
-      if (epgDoc.GetParseError())
-      {
-        kodi::Log(ADDON_LOG_ERROR, "[GetEPG] ERROR: error while parsing json");
-        return PVR_ERROR_SERVER_ERROR;
-      }
-      cache_document.CopyFrom(epgDoc, cache_document.GetAllocator());
-      cache_url = url;
+      m_refreshThreadCondition.wait_until(lock, std::min(channelsDue, epgDue));
     }
+  }
+}
 
+PVR_ERROR PlutotvData::GetEPGForChannel(int channelUid,
+                                        time_t start,
+                                        time_t end,
+                                        kodi::addon::PVREPGTagsResultSet& results)
+{
+  Metrics::Timer timer(m_metrics, "epg.call_ms");
+  const time_t now = std::time(nullptr);
+  if (start < now)
+  {
+    if (m_verboseLogging)
+      kodi::Log(ADDON_LOG_DEBUG, "[epg] adjusting start time to 'now' minus 3 hrs");
+    start = now - 7200; // Pluto.tv API returns nothing if we step back (to wide) in time.
+  }
+  if (end - now > m_epgSpan)
+    m_epgSpan = end - now;
+  SnapEpgWindow(start, end);
+
+  const std::shared_ptr<const PlutotvChannelTable> table = GetChannelTable();
+  const PlutotvChannel* thisChannel = table->Find(channelUid);
+  if (!thisChannel)
+    return PVR_ERROR_NO_ERROR;
+  const std::string& plutotvID = thisChannel->plutotvID;
+
+  std::shared_ptr<const PlutotvEpgStore> store = GetEpgStore();
+  if (store && store->start <= start && store->end >= end)
+  {
+    m_metrics.Increment("epg.store_hit");
+  }
+  else
+  {
+    // the prefetcher has not covered this window (yet): fetch it once for all channels
+    m_metrics.Increment("epg.store_miss");
+    std::lock_guard<std::mutex> refreshLock(m_epgRefreshMutex);
+    store = GetEpgStore();
+    if (!store || store->start > start || store->end < end)
+      store = RefreshEpg(start, end);
+    if (!store)
+      return PVR_ERROR_SERVER_ERROR;
+  }
 
-    kodi::Log(ADDON_LOG_DEBUG, "[epg] iterate entries");
+  const auto epgChannel = store->channels.find(plutotvID);
+  if (epgChannel == store->channels.end())
+    return PVR_ERROR_NO_ERROR;
 
-    kodi::Log(ADDON_LOG_DEBUG, "[epg] size: %i;", epgDoc["result"].Size());
+  int tags = 0;
+  for (const auto& entry : epgChannel->second)
+  {
+    if (entry.endTime <= start || entry.startTime >= end)
+      continue;
 
-    for (const auto& epgChannel : epgDoc["result"].GetArray())
+    kodi::addon::PVREPGTag tag;
+
+    tag.SetUniqueBroadcastId(entry.iUniqueBroadcastId);
+    tag.SetUniqueChannelId(channelUid);
+    if (entry.strTitle)
+      tag.SetTitle(*entry.strTitle);
+    tag.SetStartTime(entry.startTime);
+    tag.SetEndTime(entry.endTime);
+    if (entry.strPlot)
+      tag.SetPlot(*entry.strPlot);
+    if (entry.strGenre)
     {
-      if (epgChannel["_id"].GetString() != myChannel.plutotvID)
-        continue;
-
-      for (const auto& epgData : epgChannel["timelines"].GetArray())
-      {
-        kodi::addon::PVREPGTag tag;
-
-        //    "timelines":[{
-        //          "_id":"5eccebf293483f0007d9ae18",
-        //          "start":"2020-05-27T15:41:00.000Z",
-        //          "stop":"2020-05-27T16:06:00.000Z",
-        //          "title":"Planet Max: Die Affengrippe",
-        //          "episode":{
-        //             "_id":"5d0b449900557a40f64a71ee",
-        //             "number":124,
-        //             "description":"Nesmith hat einen Schnupfen. Max, der glaubt, dass Nesmith Luft verliert und bald platt sein wird, glaubt, dass nur eine Banane Nesmith retten kann. Und so machen sich Max, Aseefa und Doppy auf die Suche nach dem rettenden Heilmittel.",
-        //             "duration":1500000,
-        //             "genre":"News and Information",
-        //             "subGenre":"Entertaining",
-        //             "distributeAs":{ "AVOD":true },
-        //             "clip":{  "originalReleaseDate":"2020-05-27T17:53:04.127Z"},
-        //             "rating":"FSK-6",
-        //             "name":"Die Affengrippe",
-        //             "poster":{ "path":"http://images.pluto.tv/assets/images/default/vod.poster-default.jpg?w=694\u0026h=1000\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur" },
-        //             "thumbnail":{ "path":"http://s3.amazonaws.com/silo.pluto.tv/origin/bluevo/nickelodeon/production/201906/20/nickelodeon_5d0a5767621cc_Planet-Max-DE-Die-Affengrippe-S1E124_1561019544860.jpg?w=440\u0026h=440\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur" },
-        //             "liveBroadcast":false,
-        //             "featuredImage":{ "path":"http://s3.amazonaws.com/silo.pluto.tv/origin/bluevo/nickelodeon/production/201906/20/nickelodeon_5d0a5767621cc_Planet-Max-DE-Die-Affengrippe-S1E124_1561019544860.jpg?w=1600\u0026h=900\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur" },
-        //             "series":{
-        //                "_id":"5d0b449100557a40f64a71ad",
-        //                "name":"Planet Max",
-        //                "type":"tv",
-        //                "tile":{"path":"http://images.pluto.tv/series/5d0b449100557a40f64a71ad/tile.jpg?w=660\u0026h=660\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur" },
-        //                "description":"Max, der beste Freund von Jimmy Neutron, schaut sich in Jimmys Labor um u.... Zeenu.",
-        //                "summary":"Max, der beste Freund von Jimmy Neut ... chließlich auf dem Planeten Zeenu.",
-        //                "featuredImage":{
-        //                   "path":"http://images.pluto.tv/series/5d0b449100557a40f64a71ad/featuredImage.jpg?w=1600\u0026h=900\u0026fm=jpg\u0026q=75\u0026fit=fill\u0026fill=blur"
-        //                } }  }   },
-
-        // generate a unique boadcast id
-        string epg_bid = epgData["_id"].GetString();
-        kodi::Log(ADDON_LOG_DEBUG, "[epg] epg_bid: %s;", epg_bid.c_str());
-        int dirtyID = Utils::GetIDDirty(epg_bid);
-        kodi::Log(ADDON_LOG_DEBUG, "[epg] epg_bid dirty: %i;", dirtyID);
-        tag.SetUniqueBroadcastId(dirtyID);
-
-        // channel ID
-        tag.SetUniqueChannelId(myChannel.iUniqueId);
-
-        // set title
-        tag.SetTitle(epgData["title"].GetString());
-        kodi::Log(ADDON_LOG_DEBUG, "[epg] title: %s;", epgData["title"].GetString());
-
-        // set startTime
-        string startTime = epgData["start"].GetString();
-        tag.SetStartTime(Utils::StringToTime(startTime));
-
-        // set endTime
-        string endTime = epgData["stop"].GetString();
-        tag.SetEndTime(Utils::StringToTime(endTime));
-
-        if (epgData.HasMember("episode"))
-        {
-
-          // set description
-          if (epgData["episode"].HasMember("description") &&
-              epgData["episode"]["description"].IsString())
-          {
-            tag.SetPlot(epgData["episode"]["description"].GetString());
-            kodi::Log(ADDON_LOG_DEBUG, "[epg] description: %s;",
-                      epgData["episode"]["description"].GetString());
-          }
-
-          // genre
-          if (epgData["episode"].HasMember("genre") && epgData["episode"]["genre"].IsString())
-          {
-            tag.SetGenreType(EPG_GENRE_USE_STRING);
-            tag.SetGenreDescription(epgData["episode"]["genre"].GetString());
-          }
-
-          // thumbnail
-          if (epgData["episode"].HasMember("thumbnail") &&
-              epgData["episode"]["thumbnail"]["path"].IsString())
-          {
-            tag.SetIconPath(epgData["episode"]["thumbnail"]["path"].GetString());
-          }
-        }
-
-        results.Add(tag);
-      }
+      tag.SetGenreType(EPG_GENRE_USE_STRING);
+      tag.SetGenreDescription(*entry.strGenre);
     }
+    if (!entry.strIconPath.IsEmpty())
+      tag.SetIconPath(entry.strIconPath.Get());
+
+    results.Add(tag);
+    ++tags;
   }
+
+  m_metrics.Add("epg.tags_per_call", tags);
+  if (m_verboseLogging)
+    kodi::Log(ADDON_LOG_DEBUG, "[epg] channel %s: %i tags", plutotvID.c_str(), tags);
   return PVR_ERROR_NO_ERROR;
 }
 
+PVR_ERROR PlutotvData::CallSettingsMenuHook(const kodi::addon::PVRMenuhook& menuhook)
+{
+  if (menuhook.GetHookId() == PLUTOTV_MENUHOOK_METRICS)
+  {
+    m_metrics.Dump();
+    return PVR_ERROR_NO_ERROR;
+  }
+  return PVR_ERROR_INVALID_PARAMETERS;
+}
+
 ADDONCREATOR(PlutotvData)
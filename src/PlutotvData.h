@@ -8,10 +8,23 @@
 
 #pragma once
 
-#include "Curl.h"
+#include "BroadcastIds.h"
+#include "HttpTransport.h"
+#include "KodiFileReadStream.h"
+#include "Metrics.h"
+#include "ParseArena.h"
+#include "PlutotvTypes.h"
 #include "kodi/addon-instance/PVR.h"
-#include "rapidjson/document.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 /**
@@ -20,11 +33,91 @@
 static const std::string PLUTOTV_USER_AGENT =
     "Mozilla/5.0 (Windows NT 6.2; rv:24.0) Gecko/20100101 Firefox/24.0";
 
+/**
+ * Host of the API, prewarmed on startup
+ */
+static const std::string PLUTOTV_API_URL = "https://api.pluto.tv";
+
+/**
+ * Values of the http_transport setting
+ */
+static const int PLUTOTV_TRANSPORT_LIVE = 0;
+static const int PLUTOTV_TRANSPORT_REPLAY = 1;
+static const int PLUTOTV_TRANSPORT_RECORD = 2;
+
+/**
+ * Recordings of the replay transport when no replay_path is set, in the add-on
+ * profile directory
+ */
+static const std::string PLUTOTV_REPLAY_DIRECTORY = "replay/";
+
+/**
+ * Read buffer of a streamed JSON download and the default chunk size (KiB,
+ * setting parse_arena_chunk) of the parser memory pools
+ */
+static const size_t PLUTOTV_PARSE_READ_BUFFER = 64 * 1024;
+static const int PLUTOTV_PARSE_ARENA_CHUNK = 64;
+
+/**
+ * Settings menu hook writing the collected metrics to the log
+ */
+static const unsigned int PLUTOTV_MENUHOOK_METRICS = 1;
+
+/**
+ * Default minutes between two background refreshes of the EPG window and of
+ * the channel list, and the percentage each interval is randomly stretched
+ * or shortened by so that installations don't all hit the API in step
+ */
+static const int PLUTOTV_EPG_REFRESH_INTERVAL = 60;
+static const int PLUTOTV_CHANNEL_REFRESH_INTERVAL = 6 * 60;
+static const int PLUTOTV_REFRESH_JITTER = 10;
+
+/**
+ * Seconds until a failed background refresh is tried again, doubled with
+ * every further failure up to the maximum
+ */
+static const int PLUTOTV_REFRESH_RETRY = 60;
+static const int PLUTOTV_REFRESH_RETRY_MAX = 15 * 60;
+
+/**
+ * Channel snapshot in the add-on profile directory, read on startup
+ */
+static const std::string PLUTOTV_CHANNEL_CACHE_FILE = "channels.bin";
+static const uint32_t PLUTOTV_CHANNEL_CACHE_VERSION = 3;
+
+/**
+ * Seconds GetChannels waits for a background channel load before it
+ * answers with what is known so far
+ */
+static const int PLUTOTV_CHANNEL_LOAD_TIMEOUT = 10;
+
+/**
+ * EPG windows are snapped to whole buckets of this many seconds, so every
+ * channel asked for within one bucket shares the same download
+ */
+static const time_t PLUTOTV_EPG_BUCKET = 60 * 60;
+
+/**
+ * Seconds of schedule prefetched ahead of 'now' until Kodi asks for more
+ */
+static const time_t PLUTOTV_EPG_PREFETCH_SPAN = 24 * 60 * 60;
+
+/**
+ * Refreshes only download the schedule past the stored window; once its
+ * oldest download is this many seconds old the whole window is fetched again
+ */
+static const time_t PLUTOTV_EPG_FULL_REFRESH = 24 * 60 * 60;
+
 class ATTRIBUTE_HIDDEN PlutotvData : public kodi::addon::CAddonBase,
                                      public kodi::addon::CInstancePVRClient
 {
 public:
   PlutotvData() = default;
+  /**
+   * Use transport for all requests instead of the one configured in the settings
+   */
+  explicit PlutotvData(std::unique_ptr<HttpTransport> transport);
+  ~PlutotvData() override;
   PlutotvData(const PlutotvData&) = delete;
   PlutotvData(PlutotvData&&) = delete;
   PlutotvData& operator=(const PlutotvData&) = delete;
@@ -56,32 +149,113 @@ public:
                              time_t end,
                              kodi::addon::PVREPGTagsResultSet& results) override;
 
+  PVR_ERROR CallSettingsMenuHook(const kodi::addon::PVRMenuhook& menuhook) override;
+
 
 private:
-  struct PlutotvChannel
+  // benchmark/PlutotvHarness.h drives the load and refresh paths directly, without Create()
+  friend class PlutotvHarness;
+
+  /**
+   * All-channel EPG converted from one bulk download of the bucketed window
+   * start..end. Immutable once published; channels maps a plutotvID to its
+   * entries sorted by start time. The API answers for all channels at once,
+   * so every channel covers the same start..end.
+   */
+  struct PlutotvEpgStore
+  {
+    time_t start;
+    time_t end;
+    time_t downloaded; // of the oldest part of start..end
+    std::unordered_map<std::string, std::vector<PlutotvEpgEntry>> channels;
+  };
+
+  /**
+   * The last full EPG download, which the refreshes revalidate until the next one
+   */
+  struct PlutotvEpgDownload
   {
-    int iUniqueId;
-    std::string plutotvID;
-    int iChannelNumber; //position
-    std::string strChannelName;
-    std::string strIconPath;
-    std::string strStreamURL;
+    std::string url;
+    time_t start;
+    time_t end;
+    HttpValidators validators;
   };
 
-  rapidjson::Document cache_document;
-  std::string cache_url = "";
+  std::shared_ptr<const PlutotvEpgStore> m_epgStore; // std::atomic_load / atomic_store only
+  std::mutex m_epgRefreshMutex;
+  PlutotvEpgDownload m_epgDownload{}; // m_epgRefreshMutex
+  BroadcastIds m_broadcastIds; // m_epgRefreshMutex
+  StringPool m_epgStrings; // m_epgRefreshMutex, shared by the stored EPG and the next download
+  std::atomic<time_t> m_epgSpan{PLUTOTV_EPG_PREFETCH_SPAN};
 
+  // runs channel and EPG refreshes off Kodi's call threads; intervals in seconds
+  std::thread m_refreshThread;
+  std::mutex m_refreshThreadMutex;
+  std::condition_variable m_refreshThreadCondition;
+  bool m_refreshThreadStop = false;
+  std::atomic<int> m_epgRefreshInterval{PLUTOTV_EPG_REFRESH_INTERVAL * 60};
+  std::atomic<int> m_channelRefreshInterval{PLUTOTV_CHANNEL_REFRESH_INTERVAL * 60};
+  std::atomic<int> m_refreshJitter{PLUTOTV_REFRESH_JITTER};
 
   ADDON_STATUS m_curStatus = ADDON_STATUS_OK;
 
+  std::unique_ptr<HttpTransport> m_transport;
+  std::thread m_prewarmThread;
+
+  Metrics m_metrics;
+
+  // idle parse arenas, one per concurrent download at most
+  std::mutex m_arenasMutex;
+  std::vector<std::unique_ptr<ParseArena>> m_arenas;
+  size_t m_arenaChunkSize = PLUTOTV_PARSE_ARENA_CHUNK * 1024;
+  std::atomic<bool> m_verboseLogging{false};
 
-  std::vector<PlutotvChannel> m_channels;
+
+  /**
+   * Channels sharing a Pluto category; members are indexes into the table's
+   * channels, in position order. Groups are in the order their first channel
+   * appears.
+   */
+  struct PlutotvChannelGroup
+  {
+    std::string name;
+    std::vector<size_t> members;
+  };
+
+  /**
+   * The channel list with its indexes. Immutable once published: readers
+   * take the current table with GetChannelTable() and never wait for a
+   * refresh, which builds the next one and swaps it in (SetChannels).
+   */
+  struct PlutotvChannelTable
+  {
+    std::vector<PlutotvChannel> channels;
+    std::unordered_map<int, size_t> byUniqueId;
+    std::unordered_map<std::string, size_t> byPlutotvId;
+    std::vector<PlutotvChannelGroup> groups;
+    std::unordered_map<std::string, size_t> groupsByName;
+
+    const PlutotvChannel* Find(int uniqueId) const;
+  };
+
+  // only through std::atomic_load / std::atomic_store
+  std::shared_ptr<const PlutotvChannelTable> m_channelTable =
+      std::make_shared<const PlutotvChannelTable>();
+  HttpValidators m_channelsValidators;
+  std::mutex m_channelsMutex; // serialises the writers of m_channelTable, m_channelsValidators
+  std::condition_variable m_channelsCondition;
+  std::atomic<bool> m_channelsLoaded{false};
 
   void AddTimerType(std::vector<kodi::addon::PVRTimerType>& types, int idx, int attributes);
 
   std::string GetChannelStreamUrl(int uniqueId);
   std::string GetLicense(void);
   std::string GetSettingsUUID(std::string setting);
+
+  std::mutex m_settingsMutex;
+  std::atomic<bool> m_streamIdsValid{false};
+  std::string m_deviceId;
+  std::string m_sid;
   void SetStreamProperties(std::vector<kodi::addon::PVRStreamProperty>& properties,
                            const std::string& url,
                            bool realtime);
@@ -92,10 +266,41 @@ private:
   std::string HttpRequest(const std::string& action,
                           const std::string& url,
                           const std::string& postData);
-  std::string HttpRequestToCurl(Curl& curl,
-                                const std::string& action,
-                                const std::string& url,
-                                const std::string& postData,
-                                int& statusCode);
-  bool LoadChannelData(void);
+  bool HttpGetJson(
+      const std::string& url,
+      const std::function<bool(KodiFileReadStream& stream, ParseArena::Allocator& arena)>& parser,
+      HttpValidators* validators = nullptr);
+  std::unique_ptr<ParseArena> AcquireArena(void);
+  void ReleaseArena(std::unique_ptr<ParseArena> arena);
+  static std::unique_ptr<HttpTransport> CreateTransport(void);
+  bool LoadChannelData(PlutotvDelta* delta = nullptr);
+  PlutotvDelta DiffChannels(const std::vector<PlutotvChannel>& channels);
+  void SetChannels(std::vector<PlutotvChannel>&& channels);
+  std::shared_ptr<const PlutotvChannelTable> GetChannelTable(bool waitForLoad = false);
+  bool RefreshChannels(void);
+  void SetChannelsLoaded(void);
+  bool LoadChannelCache(void);
+  void SaveChannelCache(void);
+  static void SnapEpgWindow(time_t& start, time_t& end);
+  std::shared_ptr<const PlutotvEpgStore> GetEpgStore();
+  std::shared_ptr<const PlutotvEpgStore> RefreshEpg(time_t start,
+                                                    time_t end,
+                                                    bool revalidate = false);
+  std::shared_ptr<const PlutotvEpgStore> RevalidateEpg(
+      const std::shared_ptr<const PlutotvEpgStore>& current, time_t start);
+  std::shared_ptr<const PlutotvEpgStore> PublishEpg(
+      const std::shared_ptr<const PlutotvEpgStore>& current,
+      const std::shared_ptr<PlutotvEpgStore>& store);
+  static size_t MergeEpg(
+      const PlutotvEpgStore& current,
+      std::unordered_map<std::string, std::vector<PlutotvEpgEntry>>& downloaded,
+      time_t from,
+      time_t to,
+      PlutotvEpgStore& store);
+  static PlutotvDelta DiffEpg(const std::vector<PlutotvEpgEntry>& before,
+                              const std::vector<PlutotvEpgEntry>& after,
+                              time_t start,
+                              time_t end);
+  bool PrefetchEpg(void);
+  void RefreshProcess(bool loadChannels);
 };
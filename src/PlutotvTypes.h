@@ -0,0 +1,89 @@
+/*
+ *  Copyright (C) 2020 flubshi (https://github.com/flubshi)
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "ContentHash.h"
+#include "StreamUrlTemplate.h"
+#include "StringPool.h"
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <string>
+
+/**
+ * A 12 byte Pluto (MongoDB) _id, kept binary instead of as 24 hex digits
+ */
+typedef std::array<uint8_t, 12> PlutotvObjectId;
+
+struct PlutotvChannel
+{
+  int iUniqueId;
+  std::string plutotvID;
+  int iChannelNumber; //position
+  std::string strChannelName;
+  std::string strCategory; // channel group, empty for none
+  InternedUrl strIconPath;
+  StreamUrlTemplate streamUrl;
+  uint64_t contentHash; // of the fields above, see ComputeHash()
+
+  uint64_t ComputeHash() const
+  {
+    return ContentHash()
+        .Add(static_cast<int64_t>(iUniqueId))
+        .Add(plutotvID)
+        .Add(static_cast<int64_t>(iChannelNumber))
+        .Add(strChannelName)
+        .Add(strCategory)
+        .Add(strIconPath)
+        .Add(streamUrl.GetUrl())
+        .Get();
+  }
+};
+
+/**
+ * Programmes repeat over a multi-day window and share genres and image
+ * hosts, so the strings are interned; nullptr / empty when not set
+ */
+struct PlutotvEpgEntry
+{
+  PlutotvObjectId timelineId;
+  int iUniqueBroadcastId; // from BroadcastIds, 0 until the entry is stored
+  InternedString strTitle;
+  time_t startTime;
+  time_t endTime;
+  InternedString strPlot;
+  InternedString strGenre;
+  InternedUrl strIconPath;
+  uint64_t contentHash; // of the programme, see ComputeHash()
+
+  uint64_t ComputeHash() const
+  {
+    return ContentHash()
+        .Add(strTitle)
+        .Add(static_cast<int64_t>(startTime))
+        .Add(static_cast<int64_t>(endTime))
+        .Add(strPlot)
+        .Add(strGenre)
+        .Add(strIconPath)
+        .Get();
+  }
+};
+
+/**
+ * What a refresh changed, by plutotvID / timeline _id
+ */
+struct PlutotvDelta
+{
+  size_t added = 0;
+  size_t removed = 0;
+  size_t changed = 0;
+
+  bool IsEmpty() const { return added == 0 && removed == 0 && changed == 0; }
+};
@@ -0,0 +1,250 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "ReplayTransport.h"
+
+#include "kodi/General.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <utility>
+
+using namespace std;
+
+namespace
+{
+const uint64_t HASH_SEED = 14695981039346656037ULL;
+
+// FNV-1a, only needs to be stable across runs
+uint64_t HashBytes(uint64_t hash, const char* data, size_t size)
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+uint64_t HashString(const string& str)
+{
+  return HashBytes(HASH_SEED, str.data(), str.size());
+}
+} // unnamed namespace
+
+ReplayTransport::ReplayTransport(const string& directory,
+                                 int latencyMs,
+                                 int failurePercent,
+                                 std::unique_ptr<HttpTransport> recorder)
+  : m_directory(directory),
+    m_latencyMs(latencyMs),
+    m_failurePercent(failurePercent),
+    m_recorder(std::move(recorder))
+{
+  if (!m_directory.empty() && m_directory.back() != '/' && m_directory.back() != '\\')
+    m_directory += '/';
+  kodi::Log(ADDON_LOG_INFO, "[replay] serving %s, latency %i ms, failure rate %i%%%s",
+            m_directory.c_str(), m_latencyMs, m_failurePercent,
+            m_recorder ? ", recording" : "");
+}
+
+bool ReplayTransport::Request(
+    const string& action, const string& url, const string& postData, int& statusCode, string& body)
+{
+  body.clear();
+  if (!Inject(statusCode))
+    return false;
+
+  const string path = FindRecording(action, url);
+  if (!path.empty() && ReadRecording(path, body))
+  {
+    statusCode = 200;
+    return true;
+  }
+
+  if (m_recorder)
+  {
+    if (!m_recorder->Request(action, url, postData, statusCode, body))
+      return false;
+    if (statusCode == 200)
+      Record(action, url, body);
+    return true;
+  }
+
+  kodi::Log(ADDON_LOG_WARNING, "[replay] no recording for %s %s", action.c_str(), url.c_str());
+  statusCode = 404;
+  return true;
+}
+
+bool ReplayTransport::GetStream(const string& url,
+                                int& statusCode,
+                                const std::function<void(kodi::vfs::CFile& file)>& reader,
+                                HttpValidators* validators)
+{
+  if (!Inject(statusCode))
+    return false;
+
+  string path = FindRecording("GET", url);
+  if (path.empty() && m_recorder)
+  {
+    // record the whole body first, then stream it from disk like a replayed one
+    string body;
+    if (!m_recorder->Request("GET", url, "", statusCode, body) || statusCode != 200)
+      return false;
+    Record("GET", url, body);
+    path = FindRecording("GET", url);
+  }
+
+  kodi::vfs::CFile file;
+  if (path.empty() || !file.OpenFile(path, ADDON_READ_NO_CACHE))
+  {
+    kodi::Log(ADDON_LOG_WARNING, "[replay] no recording for GET %s", url.c_str());
+    statusCode = 404;
+    return false;
+  }
+
+  if (validators)
+  {
+    // an ETag from the recording's content, so revalidation can be replayed as well
+    char etag[24];
+    snprintf(etag, sizeof(etag), "\"%016llx\"",
+             static_cast<unsigned long long>(HashRecording(path)));
+
+    validators->notModified = validators->etag == etag;
+    validators->etag = etag;
+    validators->lastModified.clear();
+    if (validators->notModified)
+    {
+      statusCode = 304;
+      return true;
+    }
+  }
+
+  statusCode = 200;
+  reader(file);
+  return true;
+}
+
+void ReplayTransport::Prewarm(const string& url)
+{
+  if (m_recorder)
+    m_recorder->Prewarm(url);
+}
+
+bool ReplayTransport::Inject(int& statusCode)
+{
+  if (m_latencyMs > 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(m_latencyMs));
+
+  if (m_failurePercent <= 0)
+    return true;
+
+  int roll;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    roll = std::uniform_int_distribution<int>(0, 99)(m_random);
+  }
+  if (roll >= m_failurePercent)
+    return true;
+
+  kodi::Log(ADDON_LOG_DEBUG, "[replay] injected failure");
+  statusCode = -1;
+  return false;
+}
+
+string ReplayTransport::RecordingPath(const string& action, const string& url, bool withQuery) const
+{
+  string name = action + "_";
+  size_t pos = url.find("://");
+  pos = pos == string::npos ? 0 : pos + 3;
+  const size_t query = url.find('?', pos);
+  for (const char c : url.substr(pos, query == string::npos ? string::npos : query - pos))
+    name += isalnum(static_cast<unsigned char>(c)) || c == '.' || c == '-' ? c : '_';
+
+  if (withQuery && query != string::npos)
+  {
+    char hash[24];
+    snprintf(hash, sizeof(hash), "_%016llx",
+             static_cast<unsigned long long>(HashString(url.substr(query))));
+    name += hash;
+  }
+  return m_directory + name + ".body";
+}
+
+string ReplayTransport::FindRecording(const string& action, const string& url) const
+{
+  for (const bool withQuery : {true, false})
+  {
+    const string path = RecordingPath(action, url, withQuery);
+    if (kodi::vfs::FileExists(path, false))
+      return path;
+  }
+  return "";
+}
+
+bool ReplayTransport::ReadRecording(const string& path, string& body) const
+{
+  kodi::vfs::CFile file;
+  if (!file.OpenFile(path, ADDON_READ_NO_CACHE))
+    return false;
+
+  char buf[16384];
+  ssize_t nbRead;
+  while ((nbRead = file.Read(buf, sizeof(buf))) > 0)
+    body.append(buf, nbRead);
+  return true;
+}
+
+uint64_t ReplayTransport::HashRecording(const string& path) const
+{
+  // in chunks, a recorded EPG is tens of MB
+  uint64_t hash = HASH_SEED;
+  kodi::vfs::CFile file;
+  if (!file.OpenFile(path, ADDON_READ_NO_CACHE))
+    return hash;
+
+  char buf[16384];
+  ssize_t nbRead;
+  while ((nbRead = file.Read(buf, sizeof(buf))) > 0)
+    hash = HashBytes(hash, buf, static_cast<size_t>(nbRead));
+  return hash;
+}
+
+void ReplayTransport::Record(const string& action, const string& url, const string& body)
+{
+  kodi::vfs::CreateDirectory(m_directory);
+  WriteRecording(RecordingPath(action, url, true), body);
+  WriteRecording(RecordingPath(action, url, false), body);
+}
+
+void ReplayTransport::WriteRecording(const string& path, const string& body)
+{
+  // concurrent requests may record the same URL, rename makes the last one win in one piece
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ".%llu.tmp",
+           static_cast<unsigned long long>(
+               std::hash<std::thread::id>()(std::this_thread::get_id())));
+  const string tmpPath = path + suffix;
+
+  kodi::vfs::CFile file;
+  if (!file.OpenFileForWrite(tmpPath, true))
+  {
+    kodi::Log(ADDON_LOG_ERROR, "[replay] failed to write %s", tmpPath.c_str());
+    return;
+  }
+  const bool written = file.Write(body.data(), body.size()) == static_cast<ssize_t>(body.size());
+  file.Close();
+
+  if (!written || !kodi::vfs::RenameFile(tmpPath, path))
+  {
+    kodi::Log(ADDON_LOG_ERROR, "[replay] failed to store %s", path.c_str());
+    kodi::vfs::DeleteFile(tmpPath);
+  }
+}
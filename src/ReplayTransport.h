@@ -0,0 +1,66 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include "HttpTransport.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+
+/**
+ * Serves responses recorded on disk instead of asking the Pluto API, with an
+ * injected latency and failure rate, to profile and load-test the add-on
+ * deterministically.
+ *
+ * A request is looked up as <action>_<host and path>_<query hash>, then as
+ * <action>_<host and path> alone, so that a recorded EPG download answers for
+ * any window. Given a recorder, requests without a recording are passed on to
+ * it and its successful responses are stored under both names. Conditional
+ * GETs are answered with 304 while the recording is unchanged.
+ */
+class ReplayTransport : public HttpTransport
+{
+public:
+  ReplayTransport(const std::string& directory,
+                  int latencyMs,
+                  int failurePercent,
+                  std::unique_ptr<HttpTransport> recorder = nullptr);
+
+  bool Request(const std::string& action,
+               const std::string& url,
+               const std::string& postData,
+               int& statusCode,
+               std::string& body) override;
+  bool GetStream(const std::string& url,
+                 int& statusCode,
+                 const std::function<void(kodi::vfs::CFile& file)>& reader,
+                 HttpValidators* validators) override;
+  void Prewarm(const std::string& url) override;
+
+private:
+  bool Inject(int& statusCode);
+  std::string RecordingPath(const std::string& action,
+                            const std::string& url,
+                            bool withQuery) const;
+  std::string FindRecording(const std::string& action, const std::string& url) const;
+  bool ReadRecording(const std::string& path, std::string& body) const;
+  uint64_t HashRecording(const std::string& path) const;
+  void Record(const std::string& action, const std::string& url, const std::string& body);
+  void WriteRecording(const std::string& path, const std::string& body);
+
+  std::string m_directory;
+  int m_latencyMs;
+  int m_failurePercent;
+  std::unique_ptr<HttpTransport> m_recorder;
+
+  std::mutex m_mutex;
+  std::mt19937 m_random; // default seed: the same failures on every run
+};
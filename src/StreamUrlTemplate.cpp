@@ -0,0 +1,109 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "StreamUrlTemplate.h"
+
+#include "Utils.h"
+
+#include <algorithm>
+
+using namespace std;
+
+StreamUrlTemplate::StreamUrlTemplate(const string& url,
+                                     vector<shared_ptr<const Query>>& queries)
+{
+  string source = url;
+  if (Utils::ends_with(source, "?deviceType="))
+  {
+    // lazy approach by plugin.video.plutotv
+    source = Utils::ReplaceAll(
+        source, "deviceType=",
+        "deviceType=&deviceMake=&deviceModel=&&deviceVersion=unknown&appVersion=unknown&"
+        "deviceDNT=0&userId=&advertisingId=&app_name=&appName=&buildVersion=&appStoreUrl=&"
+        "architecture=&includeExtendedEvents=false");
+  }
+
+  const size_t queryPos = source.find('?');
+  m_base = source.substr(0, queryPos);
+
+  shared_ptr<Query> query = make_shared<Query>();
+  if (queryPos != string::npos)
+  {
+    query->text.reserve(source.size() - queryPos + 64);
+    query->text += '?';
+
+    // walk the parameters, filling in the generic values and marking the per-device ones
+    size_t pos = queryPos + 1;
+    while (pos <= source.size())
+    {
+      size_t end = source.find('&', pos);
+      if (end == string::npos)
+        end = source.size();
+      const string param = source.substr(pos, end - pos);
+
+      if (param == "deviceType=")
+        query->text += "deviceType=web";
+      else if (param == "deviceMake=")
+        query->text += "deviceMake=Chrome";
+      else if (param == "deviceModel=")
+        query->text += "deviceModel=Chrome";
+      else if (param == "appName=")
+        query->text += "appName=web";
+      else
+      {
+        query->text += param;
+        if (param == "deviceId=")
+          query->slots.emplace_back(query->text.size(), SLOT_DEVICE_ID);
+        else if (param == "sid=")
+          query->slots.emplace_back(query->text.size(), SLOT_SID);
+      }
+
+      if (end < source.size())
+        query->text += '&';
+      pos = end + 1;
+    }
+  }
+
+  for (const auto& known : queries)
+  {
+    if (known->text == query->text)
+    {
+      m_query = known;
+      return;
+    }
+  }
+  m_query = query;
+  queries.push_back(m_query);
+}
+
+string StreamUrlTemplate::GetUrl() const
+{
+  if (!m_query)
+    return m_base;
+  return m_base + m_query->text;
+}
+
+string StreamUrlTemplate::Fill(const string& deviceId, const string& sid) const
+{
+  string url;
+  if (!m_query)
+    return m_base;
+
+  url.reserve(m_base.size() + m_query->text.size() +
+              m_query->slots.size() * max(deviceId.size(), sid.size()));
+  url.append(m_base);
+
+  size_t pos = 0;
+  for (const auto& slot : m_query->slots)
+  {
+    url.append(m_query->text, pos, slot.first - pos);
+    url.append(slot.second == SLOT_DEVICE_ID ? deviceId : sid);
+    pos = slot.first;
+  }
+  url.append(m_query->text, pos, string::npos);
+  return url;
+}
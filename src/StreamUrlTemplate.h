@@ -0,0 +1,53 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Stitched stream URL of a channel, parsed once at load time. The constant
+ * query parameters are filled in already; device id and session id are left
+ * as slots that Fill() writes into a single pre-sized result string.
+ */
+class StreamUrlTemplate
+{
+public:
+  enum Slot
+  {
+    SLOT_DEVICE_ID,
+    SLOT_SID
+  };
+
+  /**
+   * Query part of a template, usually identical for every channel
+   */
+  struct Query
+  {
+    std::string text;
+    std::vector<std::pair<size_t, Slot>> slots;
+  };
+
+  StreamUrlTemplate() = default;
+
+  /**
+   * Parse url. Templates whose query matches one in queries share it, new
+   * queries are appended to queries.
+   */
+  StreamUrlTemplate(const std::string& url, std::vector<std::shared_ptr<const Query>>& queries);
+
+  bool IsEmpty() const { return m_base.empty(); }
+  std::string GetUrl() const;
+  std::string Fill(const std::string& deviceId, const std::string& sid) const;
+
+private:
+  std::string m_base;
+  std::shared_ptr<const Query> m_query;
+};
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#include "StringPool.h"
+
+#include <cctype>
+
+using namespace std;
+
+namespace
+{
+// ObjectIds and similar: a segment that differs per channel, series or episode
+bool IsIdSegment(const char* begin, const char* end)
+{
+  if (end - begin < 16)
+    return false;
+  for (const char* c = begin; c < end; ++c)
+  {
+    if (!isxdigit(static_cast<unsigned char>(*c)))
+      return false;
+  }
+  return true;
+}
+} // unnamed namespace
+
+string InternedUrl::Get() const
+{
+  string url;
+  url.reserve((m_prefix ? m_prefix->size() : 0) + m_middle.size() +
+              (m_suffix ? m_suffix->size() : 0));
+  if (m_prefix)
+    url += *m_prefix;
+  url += m_middle;
+  if (m_suffix)
+    url += *m_suffix;
+  return url;
+}
+
+InternedString StringPool::Intern(const char* str, size_t length)
+{
+  if (length == 0)
+    return nullptr;
+
+  const auto it = m_strings.find(string_view(str, length));
+  if (it != m_strings.end())
+  {
+    ++m_hits;
+    return it->second;
+  }
+
+  InternedString interned = make_shared<const string>(str, length);
+  m_strings.emplace(string_view(*interned), interned);
+  return interned;
+}
+
+InternedUrl StringPool::InternUrl(const char* str, size_t length)
+{
+  const char* const end = str + length;
+  const char* query = str;
+  while (query < end && *query != '?')
+    ++query;
+
+  // the prefix ends after the host and every path segment before an id or the file name
+  const size_t schemeEnd = string_view(str, query - str).find("://");
+  const char* const host = schemeEnd == string_view::npos ? str : str + schemeEnd + 3;
+  const char* prefixEnd = str;
+  const char* segment = host;
+  for (const char* c = host; c < query; ++c)
+  {
+    if (*c != '/')
+      continue;
+    if (segment != host && IsIdSegment(segment, c))
+      break;
+    prefixEnd = c + 1;
+    segment = c + 1;
+  }
+
+  return InternedUrl(Intern(str, prefixEnd - str), string(prefixEnd, query),
+                     Intern(query, end - query));
+}
+
+size_t StringPool::Sweep()
+{
+  // only the pool can hand out a string it alone holds, so nobody takes a new reference meanwhile
+  size_t swept = 0;
+  for (auto it = m_strings.begin(); it != m_strings.end();)
+  {
+    if (it->second.use_count() == 1)
+    {
+      it = m_strings.erase(it);
+      ++swept;
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  return swept;
+}
@@ -0,0 +1,82 @@
+/*
+ *  Copyright (C) 2021 Team Kodi (https://kodi.tv)
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ *  See LICENSE.md for more information.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * Interned string: all equal strings interned through one pool share a
+ * single immutable copy. nullptr stands for the empty string.
+ */
+typedef std::shared_ptr<const std::string> InternedString;
+
+/**
+ * Image URL split into an interned prefix (scheme, host and the path up to
+ * the first id), its own middle and an interned suffix (the query, usually
+ * one of a handful of "?w=...&fit=fill&fill=blur" variants). The middle is
+ * not interned: an episode airs only a few times within a window, too few
+ * for a pool entry to cost less than the copies.
+ */
+class InternedUrl
+{
+public:
+  InternedUrl() = default;
+  InternedUrl(InternedString prefix, std::string middle, InternedString suffix)
+    : m_prefix(std::move(prefix)), m_middle(std::move(middle)), m_suffix(std::move(suffix))
+  {
+  }
+
+  bool IsEmpty() const { return !m_prefix && m_middle.empty() && !m_suffix; }
+
+  /**
+   * Reconstruct the URL
+   */
+  std::string Get() const;
+
+private:
+  friend class ContentHash;
+
+  InternedString m_prefix;
+  std::string m_middle;
+  InternedString m_suffix;
+};
+
+/**
+ * Pool the parsers intern the EPG and channel strings into. Not
+ * thread-safe. The EPG pool is kept across refreshes, so a download shares
+ * the strings of the store it replaces; Sweep() drops what only the pool
+ * still holds. The channel parsers use a pool per parse.
+ */
+class StringPool
+{
+public:
+  InternedString Intern(const char* str, size_t length);
+  InternedString Intern(const std::string& str) { return Intern(str.data(), str.size()); }
+  InternedUrl InternUrl(const char* str, size_t length);
+  InternedUrl InternUrl(const std::string& str) { return InternUrl(str.data(), str.size()); }
+
+  /**
+   * Drop the strings nothing outside the pool refers to anymore, returns how many
+   */
+  size_t Sweep();
+
+  /**
+   * Number of distinct strings and of lookups answered with one of them
+   */
+  size_t GetSize() const { return m_strings.size(); }
+  size_t GetHits() const { return m_hits; }
+
+private:
+  // keys view into the interned strings themselves
+  std::unordered_map<std::string_view, InternedString> m_strings;
+  size_t m_hits = 0;
+};
@@ -13,6 +13,7 @@
 #include "kodi/General.h"
 
 #include <algorithm>
+#include <ctime>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
@@ -97,42 +98,122 @@ std::string Utils::ReadFile(const std::string& path)
     return "";
   }
 
-  char buf[1025];
+  char buf[1024];
   ssize_t nbRead;
   std::string content;
-  while ((nbRead = file.Read(buf, 1024)) > 0)
+  while ((nbRead = file.Read(buf, sizeof(buf))) > 0)
+    content.append(buf, nbRead);
+
+  return content;
+}
+
+namespace
+{
+bool ParseDigits(const char* str, int count, int& value)
+{
+  value = 0;
+  for (int i = 0; i < count; ++i)
   {
-    buf[nbRead] = 0;
-    content.append(buf);
+    const unsigned digit = static_cast<unsigned char>(str[i]) - '0';
+    if (digit > 9)
+      return false;
+    value = value * 10 + static_cast<int>(digit);
   }
+  return true;
+}
 
-  return content;
+// days since 1970-01-01 of a proleptic Gregorian date, see
+// http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+int64_t DaysFromCivil(int year, int month, int day)
+{
+  year -= month <= 2;
+  const int era = (year >= 0 ? year : year - 399) / 400;
+  const int yearOfEra = year - era * 400;
+  const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return static_cast<int64_t>(era) * 146097 + dayOfEra - 719468;
 }
+} // unnamed namespace
 
-time_t Utils::StringToTime(std::string timeString)
+bool Utils::ParseTime(const char* str, size_t length, time_t& time)
 {
-  // expected timeString "2019-01-20T15:40:00+0100"
-  struct tm tm
+  // "2020-05-27T15:41:00.000Z", "2019-01-20T15:40:00+0100"; also "+01:00" and no zone (UTC)
+  int year, month, day, h, m, s;
+  if (length < 19 || str[4] != '-' || str[7] != '-' || str[10] != 'T' || str[13] != ':' ||
+      str[16] != ':' || !ParseDigits(str, 4, year) || !ParseDigits(str + 5, 2, month) ||
+      !ParseDigits(str + 8, 2, day) || !ParseDigits(str + 11, 2, h) ||
+      !ParseDigits(str + 14, 2, m) || !ParseDigits(str + 17, 2, s))
+    return false;
+  if (month < 1 || month > 12 || day < 1 || day > 31 || h > 23 || m > 59 || s > 60)
+    return false;
+
+  size_t pos = 19;
+  if (pos < length && str[pos] == '.')
   {
-  };
+    // fractions of a second are dropped
+    ++pos;
+    while (pos < length && str[pos] >= '0' && str[pos] <= '9')
+      ++pos;
+  }
 
-  int year, month, day, h, m, s, tzh, tzm;
-  if (sscanf(timeString.c_str(), "%d-%d-%dT%d:%d:%d%d", &year, &month, &day, &h, &m, &s, &tzh) < 7)
+  int offset = 0;
+  if (pos < length && str[pos] == 'Z')
+  {
+    ++pos;
+  }
+  else if (pos < length && (str[pos] == '+' || str[pos] == '-'))
   {
-    tzh = 0;
+    const int sign = str[pos] == '-' ? -1 : 1;
+    int tzh, tzm = 0;
+    if (length - pos < 3 || !ParseDigits(str + pos + 1, 2, tzh))
+      return false;
+    pos += 3;
+    if (pos < length && str[pos] == ':')
+      ++pos;
+    if (pos < length)
+    {
+      if (length - pos < 2 || !ParseDigits(str + pos, 2, tzm))
+        return false;
+      pos += 2;
+    }
+    offset = sign * (tzh * 3600 + tzm * 60);
   }
-  tzm = tzh % 100;
-  tzh = tzh / 100;
+  if (pos != length)
+    return false;
 
-  tm.tm_year = year - 1900;
-  tm.tm_mon = month - 1;
-  tm.tm_mday = day;
-  tm.tm_hour = h - tzh;
-  tm.tm_min = m - tzm;
-  tm.tm_sec = s;
+  time = static_cast<time_t>(DaysFromCivil(year, month, day) * 86400 + h * 3600 + m * 60 + s -
+                             offset);
+  return true;
+}
+
+size_t Utils::ParseTimes(const std::string_view* strings, size_t count, time_t* times)
+{
+  size_t parsed = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (ParseTime(strings[i].data(), strings[i].size(), times[i]))
+      ++parsed;
+    else
+      times[i] = 0;
+  }
+  return parsed;
+}
 
-  time_t ret = timegm(&tm);
-  return ret;
+std::string Utils::TimeToString(time_t time)
+{
+  // UTC, as expected by the pluto.tv API: "2020-05-27T15:04:05Z"
+  struct tm tm
+  {
+  };
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
+  gmtime_s(&tm, &time);
+#else
+  gmtime_r(&time, &tm);
+#endif
+
+  char buffer[32];
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &tm);
+  return buffer;
 }
 
 std::string Utils::ltrim(std::string str, const std::string chars)
@@ -141,16 +222,30 @@ std::string Utils::ltrim(std::string str, const std::string chars)
   return str;
 }
 
-int Utils::GetIDDirty(std::string str)
+bool Utils::HexToBytes(const char* hex, size_t length, uint8_t* bytes, size_t size)
 {
-  // str= "_1035245078" or = "misc-rand-int-whatever"
-  if (str.rfind("_", 0) == 0)
+  if (length != size * 2)
+    return false;
+
+  for (size_t i = 0; i < length; ++i)
   {
-    // str starts with _
-    return stoi(ltrim(str));
+    const char c = hex[i];
+    uint8_t nibble;
+    if (c >= '0' && c <= '9')
+      nibble = c - '0';
+    else if (c >= 'a' && c <= 'f')
+      nibble = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      nibble = c - 'A' + 10;
+    else
+      return false;
+
+    if (i % 2 == 0)
+      bytes[i / 2] = nibble << 4;
+    else
+      bytes[i / 2] |= nibble;
   }
-  // dirty shit begins here:
-  return rand() % 99999 + 1;
+  return true;
 }
 
 int Utils::GetChannelId(const char* strChannelName)
@@ -9,8 +9,10 @@
 
 #pragma once
 
+#include <cstdint>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
@@ -28,9 +30,11 @@ public:
   static std::vector<std::string> SplitString(const std::string& str,
                                               const char& delim,
                                               int maxParts = 0);
-  static time_t StringToTime(std::string timeString);
+  static bool ParseTime(const char* str, size_t length, time_t& time);
+  static size_t ParseTimes(const std::string_view* strings, size_t count, time_t* times);
+  static std::string TimeToString(time_t time);
   static std::string ltrim(std::string str, const std::string chars = "\t\n\v\f\r _");
-  static int GetIDDirty(std::string str);
+  static bool HexToBytes(const char* hex, size_t length, uint8_t* bytes, size_t size);
   static int GetChannelId(const char* strChannelName);
   static int stoiDefault(std::string str, int i);
   static bool ends_with(std::string const& haystack, std::string const& end);